@@ -653,6 +653,7 @@ static void posixExceptionHandler(int signum)
 		raise(signum);
 	}
 	allreadyRunning = 1;
+	debugCrashFlush();  // so that the log file has the lines leading up to the crash
 	// we use our write directory (which is the only directory that wz should have access to)
 	// and stuff it into our logs directory (same as on windows)
 	ssprintf(gdmpPath, "%slogs/%s", WritePath, gdmpFile);
@@ -508,6 +508,7 @@ LONG WINAPI TopLevelExceptionFilter(PEXCEPTION_POINTERS pExceptionInfo)
 		UINT fuOldErrorMode;
 
 		bBeenHere = TRUE;
+		debugCrashFlush();  // so that the log file has the lines leading up to the crash
 
 		fuOldErrorMode = SetErrorMode(SEM_FAILCRITICALERRORS | SEM_NOGPFAULTERRORBOX | SEM_NOOPENFILEERRORBOX);
 
@@ -32,6 +32,7 @@
 #include <time.h>
 #include "string_ext.h"
 #include "wzapp.h"
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -39,8 +40,13 @@
 #include <execinfo.h>  // Nonfatal runtime backtraces.
 #endif // defined(WZ_OS_LINUX) && defined(__GLIBC__)
 
+#if defined(WZ_OS_WIN)
+# include <io.h>  // _write, _fileno
+#endif
+
 #if defined(WZ_OS_UNIX)
 # include <fcntl.h>
+# include <unistd.h>
 # ifndef _POSIX_C_SOURCE
 #  define _POSIX_C_SOURCE 1
 # endif
@@ -116,6 +122,9 @@ static bool debug_flush_stderr = false;
 
 static std::map<std::string, int> warning_list;	// only used for LOG_WARNING
 
+/// Protects inputBuffer, warning_list, the repeat counts of _debug() and the callbacks, so that any thread may log.
+static wz::mutex debugMutex;
+
 /**
  * Convert code_part names to enum. Case insensitive.
  *
@@ -183,23 +192,117 @@ void debug_callback_win32debug(WZ_DECL_UNUSED void **data, const char *outputBuf
 #endif // WIN32
 
 
+/// Most bytes waiting to be written to a log file. Lines beyond that are dropped and counted.
+#define LOG_FILE_QUEUE_MAX (4 * 1024 * 1024)
+
+/// Set when crashing, after which lines are written to the log files directly, since the writer thread may never run again.
+static std::atomic<bool> logFileCrashing(false);
+
+/// Write to the file descriptor of logfile, bypassing the locks of the FILE, which a crashed thread may hold.
+/// The log file is unbuffered, so nothing written through the FILE is held back.
+static void logFileWriteRaw(FILE *logfile, const char *data, size_t size)
+{
+#if defined(WZ_OS_WIN)
+	const int fd = _fileno(logfile);
+#else
+	const int fd = fileno(logfile);
+#endif
+	while (size > 0)
+	{
+#if defined(WZ_OS_WIN)
+		const int written = _write(fd, data, (unsigned int)size);
+#else
+		const ssize_t written = write(fd, data, size);
+#endif
+		if (written <= 0)
+		{
+			return;  // Nothing else to do, we are crashing.
+		}
+		data += written;
+		size -= written;
+	}
+}
+
+/// A log file, written by its own thread so that logging never waits for the disk.
+struct LOG_FILE_WRITER
+{
+	FILE *logfile = nullptr;
+	WZ_THREAD *thread = nullptr;
+	WZ_MUTEX *mutex = nullptr;        ///< Protects the members below.
+	WZ_SEMAPHORE *wakeup = nullptr;   ///< Posted when lines are queued, and on exit.
+	std::string queue;
+	size_t dropped = 0;
+	bool quit = false;
+};
+
+static int logFileWriterThread(void *data)
+{
+	LOG_FILE_WRITER *writer = (LOG_FILE_WRITER *)data;
+	std::string lines;
+	bool quit = false;
+
+	while (!quit)
+	{
+		wzSemaphoreWait(writer->wakeup);
+		wzMutexLock(writer->mutex);
+		lines.clear();
+		std::swap(lines, writer->queue);
+		size_t dropped = writer->dropped;
+		writer->dropped = 0;
+		quit = writer->quit;
+		wzMutexUnlock(writer->mutex);
+
+		fwrite(lines.data(), 1, lines.size(), writer->logfile);
+		if (dropped > 0)
+		{
+			fprintf(writer->logfile, "--- %zu log lines dropped, logging faster than the disk ---\n", dropped);
+		}
+		fflush(writer->logfile);
+	}
+	return 0;
+}
+
 /**
  * Callback for outputing to a file
  *
- * \param	data			Filehandle to output to.
+ * \param	data			The log file writer.
  * \param	outputBuffer	Buffer containing the preprocessed text to output.
  */
 void debug_callback_file(void **data, const char *outputBuffer)
 {
-	FILE *logfile = (FILE *)*data;
+	LOG_FILE_WRITER *writer = (LOG_FILE_WRITER *)*data;
+	size_t len = strlen(outputBuffer);
+	bool newline = !strchr(outputBuffer, '\n');
 
-	if (!strchr(outputBuffer, '\n'))
+	if (logFileCrashing)
 	{
-		fprintf(logfile, "%s\n", outputBuffer);
+		logFileWriteRaw(writer->logfile, outputBuffer, len);
+		if (newline)
+		{
+			logFileWriteRaw(writer->logfile, "\n", 1);
+		}
+		return;
+	}
+
+	wzMutexLock(writer->mutex);
+	bool wasEmpty = writer->queue.empty();
+	if (writer->queue.size() + len + 1 > LOG_FILE_QUEUE_MAX)
+	{
+		++writer->dropped;
 	}
 	else
 	{
-		fprintf(logfile, "%s", outputBuffer);
+		writer->queue.append(outputBuffer, len);
+		if (newline)
+		{
+			writer->queue += '\n';
+		}
+	}
+	wzMutexUnlock(writer->mutex);
+
+	if (wasEmpty)
+	{
+		wzSemaphorePost(writer->wakeup);
 	}
 }
 
@@ -254,7 +357,14 @@ bool debug_callback_file_init(void **data)
 	snprintf(WZ_DBGFile, sizeof(WZ_DBGFile), "%s", WZDebugfilename.toUtf8().c_str());
 	setbuf(logfile, nullptr);
 	fprintf(logfile, "--- Starting log [%s]---\n", WZDebugfilename.toUtf8().c_str());
-	*data = logfile;
+
+	LOG_FILE_WRITER *writer = new LOG_FILE_WRITER;
+	writer->logfile = logfile;
+	writer->mutex = wzMutexCreate();
+	writer->wakeup = wzSemaphoreCreate(0);
+	writer->thread = wzThreadCreate(logFileWriterThread, writer);
+	wzThreadStart(writer->thread);
+	*data = writer;
 
 	return true;
 }
@@ -263,17 +373,48 @@ bool debug_callback_file_init(void **data)
 /**
  * Shutdown the file callback
  *
- * Closes the logfile.
+ * Writes the remaining lines and closes the logfile.
  *
- * \param	data	The filehandle to close.
+ * \param	data	The log file writer to close.
  */
 void debug_callback_file_exit(void **data)
 {
-	FILE *logfile = (FILE *)*data;
-	fclose(logfile);
+	LOG_FILE_WRITER *writer = (LOG_FILE_WRITER *)*data;
+	wzMutexLock(writer->mutex);
+	writer->quit = true;
+	wzMutexUnlock(writer->mutex);
+	wzSemaphorePost(writer->wakeup);
+	wzThreadJoin(writer->thread);
+	wzSemaphoreDestroy(writer->wakeup);
+	wzMutexDestroy(writer->mutex);
+	fclose(writer->logfile);
+	delete writer;
 	*data = nullptr;
 }
 
+void debugCrashFlush()
+{
+	if (logFileCrashing.exchange(true))
+	{
+		return;
+	}
+	for (debug_callback *curCallback = callbackRegistry; curCallback != nullptr; curCallback = curCallback->next)
+	{
+		if (curCallback->callback == debug_callback_file)
+		{
+			// Don't wait for the mutex, the crashed thread may hold it, and then the queue may be half changed.
+			// The writer thread may still be writing the lines it took earlier, so these may end up after some later ones.
+			LOG_FILE_WRITER *writer = (LOG_FILE_WRITER *)curCallback->data;
+			if (wzMutexTryLock(writer->mutex))
+			{
+				logFileWriteRaw(writer->logfile, writer->queue.data(), writer->queue.size());
+				writer->queue.clear();
+				wzMutexUnlock(writer->mutex);
+			}
+		}
+	}
+}
+
 void debugFlushStderr()
 {
 	debug_flush_stderr = true;
@@ -335,6 +476,7 @@ void debug_init()
 
 void debug_exit()
 {
+	std::lock_guard<wz::mutex> lock(debugMutex);
 	debug_callback *curCallback = callbackRegistry, * tmpCallback = nullptr;
 
 	while (curCallback)
@@ -354,7 +496,7 @@ void debug_exit()
 
 void debug_register_callback(debug_callback_fn callback, debug_callback_init init, debug_callback_exit exit, void *data)
 {
-	debug_callback *curCallback = callbackRegistry, * tmpCallback = nullptr;
+	debug_callback *curCallback = nullptr, * tmpCallback = nullptr;
 
 	tmpCallback = (debug_callback *)malloc(sizeof(*tmpCallback));
 
@@ -372,6 +514,8 @@ void debug_register_callback(debug_callback_fn callback, debug_callback_init ini
 		return;
 	}
 
+	std::lock_guard<wz::mutex> lock(debugMutex);  // Not while calling init, which may log.
+	curCallback = callbackRegistry;
 	if (!curCallback)
 	{
 		callbackRegistry = tmpCallback;
@@ -428,6 +572,7 @@ void _realObjTrace(int id, const char *function, const char *str, ...)
 	va_end(ap);
 
 	ssprintf(outputBuffer, "[%6d]: [%s] %s", id, function, vaBuffer);
+	std::lock_guard<wz::mutex> lock(debugMutex);
 	printToDebugCallbacks(outputBuffer);
 }
 
@@ -452,7 +597,8 @@ const char *debugLastError()
 void _debug(int line, code_part part, const char *function, const char *str, ...)
 {
 	va_list ap;
-	static char outputBuffer[MAX_LEN_LOG_LINE];
+	char outputBuffer[MAX_LEN_LOG_LINE];
+	char message[MAX_LEN_LOG_LINE];   /* the line without time and part, for the dialogs shown without holding debugMutex */
 	static unsigned int repeated = 0; /* times current message repeated */
 	static unsigned int next = 2;     /* next total to print update */
 	static unsigned int prev = 0;     /* total on last update */
@@ -461,6 +607,8 @@ void _debug(int line, code_part part, const char *function, const char *str, ...
 	vssprintf(outputBuffer, str, ap);
 	va_end(ap);
 
+	std::unique_lock<wz::mutex> lock(debugMutex);
+
 	if (part == LOG_WARNING)
 	{
 		std::pair<std::map<std::string, int>::iterator, bool> ret;
@@ -533,11 +681,18 @@ void _debug(int line, code_part part, const char *function, const char *str, ...
 		ssprintf(outputBuffer, "%-8s|%s: %s", code_part_names[part], ourtime, useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
 
 		printToDebugCallbacks(outputBuffer);
+	}
+	const bool printed = !repeated;
+	sstrcpy(message, useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
+	useInputBuffer1 = !useInputBuffer1; // Swap buffers
+	lock.unlock();
 
+	if (printed)
+	{
 		if (part == LOG_ERROR)
 		{
 			// used to signal user that there was a error condition, and to check the logs.
-			sstrcpy(errorStore, useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
+			sstrcpy(errorStore, message);
 			errorWaiting = true;
 		}
 
@@ -551,11 +706,11 @@ void _debug(int line, code_part part, const char *function, const char *str, ...
 #if defined(WZ_OS_WIN)
 			char wbuf[1024];
 			ssprintf(wbuf, "%s\n\nPlease check the file (%s) in your configuration directory for more details. \
-				\nDo not forget to upload the %s file, WZdebuginfo.txt and the warzone2100.rpt files in your bug reports at https://github.com/Warzone2100/warzone2100/issues/new!", useInputBuffer1 ? inputBuffer[1] : inputBuffer[0], WZ_DBGFile, WZ_DBGFile);
+				\nDo not forget to upload the %s file, WZdebuginfo.txt and the warzone2100.rpt files in your bug reports at https://github.com/Warzone2100/warzone2100/issues/new!", message, WZ_DBGFile, WZ_DBGFile);
 			wzDisplayDialog(Dialog_Error, "Warzone has terminated unexpectedly", wbuf);
 #elif defined(WZ_OS_MAC)
 			char wbuf[1024];
-			ssprintf(wbuf, "%s\n\nPlease check your logs and attach them along with a bug report. Thanks!", useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
+			ssprintf(wbuf, "%s\n\nPlease check your logs and attach them along with a bug report. Thanks!", message);
 			int clickedIndex = \
 			                   cocoaShowAlert("Warzone has quit unexpectedly.",
 			                                  wbuf,
@@ -586,7 +741,7 @@ void _debug(int line, code_part part, const char *function, const char *str, ...
 				cocoaOpenUserCrashReportFolder();
 			}
 #else
-			const char *popupBuf = useInputBuffer1 ? inputBuffer[1] : inputBuffer[0];
+			const char *popupBuf = message;
 			wzDisplayDialog(Dialog_Error, "Warzone has terminated unexpectedly", popupBuf);
 #endif
 		}
@@ -595,11 +750,10 @@ void _debug(int line, code_part part, const char *function, const char *str, ...
 		// This is a popup dialog used for times when the error isn't fatal, but we still need to notify user what is going on.
 		if (part == LOG_POPUP)
 		{
-			wzDisplayDialog(Dialog_Information, "Warzone has detected a problem.", inputBuffer[useInputBuffer1 ? 1 : 0]);
+			wzDisplayDialog(Dialog_Information, "Warzone has detected a problem.", message);
 		}
 
 	}
-	useInputBuffer1 = !useInputBuffer1; // Swap buffers
 }
 
 void _debugBacktrace(code_part part)
@@ -231,6 +231,10 @@ void debugFlushStderr();
 /// Return the last set error message, or NULL is none set since last time we were called.
 const char *debugLastError();
 
+/// Write the lines still queued for the log files without waiting for anything, and write any later lines directly.
+/// Only for crash handlers.
+void debugCrashFlush();
+
 /**
  * Register a callback to be called on every call to debug()
  *
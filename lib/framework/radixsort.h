@@ -0,0 +1,76 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Stable radix sort of items carrying a packed 64 bit sort key.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_RADIXSORT_H__
+#define __INCLUDED_LIB_FRAMEWORK_RADIXSORT_H__
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/// Sorts items by ascending item.key, a uint64_t, keeping the order of items with equal keys.
+/// Runs one counting pass per key byte, skipping the bytes that are the same in every key.
+/// scratch is used as temporary storage, and may be kept between calls to avoid reallocating.
+template <typename T>
+void radixSortByKey(std::vector<T> &items, std::vector<T> &scratch)
+{
+	const size_t count = items.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	std::array<std::array<size_t, 256>, 8> histograms{};
+	for (const T &item : items)
+	{
+		for (unsigned byte = 0; byte < 8; ++byte)
+		{
+			++histograms[byte][(item.key >> (byte * 8)) & 0xFF];
+		}
+	}
+
+	scratch.resize(count);
+	for (unsigned byte = 0; byte < 8; ++byte)
+	{
+		std::array<size_t, 256> &histogram = histograms[byte];
+		if (histogram[(items[0].key >> (byte * 8)) & 0xFF] == count)
+		{
+			continue;  // Every key has the same value here, so this pass would not move anything.
+		}
+		size_t offset = 0;
+		for (size_t &bucket : histogram)
+		{
+			size_t bucketSize = bucket;
+			bucket = offset;
+			offset += bucketSize;
+		}
+		for (T &item : items)
+		{
+			scratch[histogram[(item.key >> (byte * 8)) & 0xFF]++] = std::move(item);
+		}
+		items.swap(scratch);
+	}
+}
+
+#endif // __INCLUDED_LIB_FRAMEWORK_RADIXSORT_H__
@@ -128,6 +128,7 @@ WZ_MUTEX *wzMutexCreate();
 WZ_DECL_NONNULL(1) void wzMutexDestroy(WZ_MUTEX *mutex);
 WZ_DECL_NONNULL(1) void wzMutexLock(WZ_MUTEX *mutex);
 WZ_DECL_NONNULL(1) void wzMutexUnlock(WZ_MUTEX *mutex);
+WZ_DECL_NONNULL(1) bool wzMutexTryLock(WZ_MUTEX *mutex);	///< Locks the mutex if no one holds it, without waiting. Returns whether it did.
 WZ_SEMAPHORE *wzSemaphoreCreate(int startValue);
 WZ_DECL_NONNULL(1) void wzSemaphoreDestroy(WZ_SEMAPHORE *semaphore);
 WZ_DECL_NONNULL(1) void wzSemaphoreWait(WZ_SEMAPHORE *semaphore);
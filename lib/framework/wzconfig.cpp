@@ -28,19 +28,134 @@
 #include "file.h"
 #include <sstream>
 #include "physfs_ext.h"
+#include "wzapp.h"
+#include "crc.h"
+#include <unordered_map>
+
+struct PENDING_JSON_FILE
+{
+	std::string fileName;
+	nlohmann::json root;
+};
+
+static bool jsonBatchOpen = false;
+static std::vector<PENDING_JSON_FILE> jsonBatch;          ///< Documents queued since saveJSONBatchBegin().
+static std::vector<PENDING_JSON_FILE> jsonWriterFiles;    ///< Documents owned by the writer thread while it runs.
+static std::vector<std::string> jsonWriterErrors;         ///< Owned by the writer thread while it runs, logged by saveJSONWaitForWrites().
+static int jsonWriterTime = 0;                            ///< Owned by the writer thread while it runs, logged by saveJSONWaitForWrites().
+static WZ_THREAD *jsonWriterThread = nullptr;
+
+static std::string formatJSON(const nlohmann::json &root)
+{
+	std::ostringstream stream;
+	stream << root.dump(4) << std::endl;
+	return stream.str();
+}
+
+static bool writeJSONFile(const nlohmann::json &root, const char *pFileName)
+{
+	std::string jsonString = formatJSON(root);
+#if SIZE_MAX >= UDWORD_MAX
+	ASSERT_OR_RETURN(false, jsonString.size() <= static_cast<size_t>(std::numeric_limits<UDWORD>::max()), "jsonString.size (%zu) exceeds UDWORD::max", jsonString.size());
+#endif
+	return saveFile(pFileName, jsonString.c_str(), static_cast<UDWORD>(jsonString.size()));
+}
+
+/// Same as writeJSONFile(), but for the writer thread, which leaves logging to saveJSONWaitForWrites().
+/// Returns why the file could not be written, or an empty string.
+static std::string writeJSONFileFromThread(const nlohmann::json &root, const char *pFileName)
+{
+	std::string jsonString = formatJSON(root);
+	if (jsonString.size() > static_cast<size_t>(std::numeric_limits<PHYSFS_uint32>::max()))
+	{
+		return std::string(pFileName) + " is too large to write";
+	}
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(pFileName);
+	if (fileHandle == nullptr)
+	{
+		return std::string(pFileName) + " could not be opened: " + WZ_PHYSFS_getLastError();
+	}
+	const PHYSFS_uint32 size = static_cast<PHYSFS_uint32>(jsonString.size());
+	if (WZ_PHYSFS_writeBytes(fileHandle, jsonString.c_str(), size) != size)
+	{
+		std::string error = std::string(pFileName) + " could not write: " + WZ_PHYSFS_getLastError();
+		PHYSFS_close(fileHandle);
+		return error;
+	}
+	if (!PHYSFS_close(fileHandle))
+	{
+		return std::string("Error closing ") + pFileName + ": " + WZ_PHYSFS_getLastError();
+	}
+	return std::string();
+}
+
+static int jsonWriterThreadFunc(void *)
+{
+	int startTime = wzGetTicks();
+	for (PENDING_JSON_FILE &file : jsonWriterFiles)
+	{
+		std::string error = writeJSONFileFromThread(file.root, file.fileName.c_str());
+		if (!error.empty())
+		{
+			jsonWriterErrors.push_back(std::move(error));
+		}
+		file.root = nlohmann::json();  // Free each document as soon as it is on disk.
+	}
+	jsonWriterTime = wzGetTicks() - startTime;
+	return jsonWriterErrors.empty() ? 1 : 0;
+}
+
+bool saveJSONToFile(nlohmann::json root, const char *pFileName)
+{
+	if (jsonBatchOpen)
+	{
+		jsonBatch.push_back(PENDING_JSON_FILE{pFileName, std::move(root)});
+		return true;
+	}
+	return writeJSONFile(root, pFileName);
+}
+
+void saveJSONBatchBegin()
+{
+	ASSERT(!jsonBatchOpen, "Batch already open");
+	jsonBatchOpen = true;
+}
+
+void saveJSONBatchEnd()
+{
+	ASSERT_OR_RETURN(, jsonBatchOpen, "No batch open");
+	jsonBatchOpen = false;
+	saveJSONWaitForWrites();  // Only one writer at a time, so files are never written out of order.
+	jsonWriterFiles = std::move(jsonBatch);
+	jsonBatch.clear();
+	jsonWriterThread = wzThreadCreate(jsonWriterThreadFunc, nullptr);
+	wzThreadStart(jsonWriterThread);
+}
+
+bool saveJSONWaitForWrites()
+{
+	static bool lastStatus = true;
+	if (jsonWriterThread != nullptr)
+	{
+		lastStatus = wzThreadJoin(jsonWriterThread) != 0;
+		jsonWriterThread = nullptr;
+		for (const std::string &error : jsonWriterErrors)
+		{
+			debug(LOG_ERROR, "%s", error.c_str());
+		}
+		debug(LOG_SAVE, "Wrote %zu files in %d ms", jsonWriterFiles.size(), jsonWriterTime);
+		jsonWriterFiles.clear();
+		jsonWriterErrors.clear();
+	}
+	return lastStatus;
+}
 
 WzConfig::~WzConfig()
 {
 	if (mWarning == ReadAndWrite)
 	{
 		ASSERT(mObjStack.empty(), "Some json groups have not been closed, stack size %zu.", mObjStack.size());
-		std::ostringstream stream;
-		stream << mRoot.dump(4) << std::endl;
-		std::string jsonString = stream.str();
-#if SIZE_MAX >= UDWORD_MAX
-		ASSERT(jsonString.size() <= static_cast<size_t>(std::numeric_limits<UDWORD>::max()), "jsonString.size (%zu) exceeds UDWORD::max", jsonString.size());
-#endif
-		saveFile(mFilename.toUtf8().c_str(), jsonString.c_str(), static_cast<UDWORD>(jsonString.size()));
+		saveJSONToFile(std::move(mRoot), mFilename.toUtf8().c_str());
 	}
 	debug(LOG_SAVE, "%s %s", mWarning == ReadAndWrite? "Saving" : "Closing", mFilename.toUtf8().c_str());
 }
@@ -67,6 +182,42 @@ static nlohmann::json jsonMerge(nlohmann::json original, const nlohmann::json& o
 	return original;
 }
 
+struct JSON_SOURCE_FILE
+{
+	std::string fileName;
+	std::string data;
+};
+
+struct JSON_CACHE_ENTRY
+{
+	Sha256 key;  ///< Hash of the file and of the diffs that were merged into root.
+	nlohmann::json root;
+};
+
+/// Parsed game data files, so that starting another game doesn't parse them again unless a file or diff changed.
+static std::unordered_map<std::string, JSON_CACHE_ENTRY> jsonCache;
+
+void jsonCacheClear()
+{
+	jsonCache.clear();
+}
+
+static Sha256 jsonCacheKey(const char *data, UDWORD size, const std::vector<JSON_SOURCE_FILE> &diffs)
+{
+	std::vector<uint8_t> hashes;
+	auto addHash = [&hashes](const void *bytes, size_t len) {
+		Sha256 hash = sha256Sum(bytes, len);
+		hashes.insert(hashes.end(), hash.bytes, hash.bytes + Sha256::Bytes);
+	};
+	addHash(data, size);
+	for (const JSON_SOURCE_FILE &diff : diffs)
+	{
+		addHash(diff.fileName.data(), diff.fileName.size());
+		addHash(diff.data.data(), diff.data.size());
+	}
+	return sha256Sum(hashes.data(), hashes.size());
+}
+
 WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 : mArray(nlohmann::json::array())
 {
@@ -100,6 +251,41 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 		debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().c_str());
 	}
 
+	std::vector<JSON_SOURCE_FILE> diffs;
+	WZ_PHYSFS_enumerateFiles("diffs", [&](const char *i) -> bool {
+		std::string str(std::string("diffs/") + i + std::string("/") + name.toUtf8().c_str());
+		if (!PHYSFS_exists(str.c_str()))
+		{
+			return true; // continue;
+		}
+		UDWORD size = 0;
+		char *data = nullptr;
+		if (!loadFile(str.c_str(), &data, &size))
+		{
+			debug(LOG_FATAL, "jsondiff file \"%s\" could not be opened!", name.toUtf8().c_str());
+		}
+		diffs.push_back(JSON_SOURCE_FILE{str, std::string(data, size)});
+		free(data);
+		return true; // continue
+	});
+
+	// Game data is taken from the cache if neither the file nor its diffs changed.
+	Sha256 cacheKey;
+	bool useCache = warning == ReadOnlyAndRequired;
+	if (useCache)
+	{
+		cacheKey = jsonCacheKey(data, size, diffs);
+		auto it = jsonCache.find(name.toUtf8());
+		if (it != jsonCache.end() && it->second.key == cacheKey)
+		{
+			mRoot = it->second.root;  // Copying is several times faster than parsing.
+			free(data);
+			debug(LOG_SAVE, "Opening %s (cached)", name.toUtf8().c_str());
+			pCurrentObj = &mRoot;
+			return;
+		}
+	}
+
 	try {
 		mRoot = nlohmann::json::parse(data, data + size);
 	}
@@ -113,21 +299,11 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 	ASSERT(!mRoot.is_null(), "JSON document from %s is null", name.toUtf8().c_str());
 	ASSERT(mRoot.is_object(), "JSON document from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
 	free(data);
-	WZ_PHYSFS_enumerateFiles("diffs", [&](const char *i) -> bool {
-		std::string str(std::string("diffs/") + i + std::string("/") + name.toUtf8().c_str());
-		if (!PHYSFS_exists(str.c_str()))
-		{
-			return true; // continue;
-		}
-		UDWORD size = 0;
-		char *data = nullptr;
-		if (!loadFile(str.c_str(), &data, &size))
-		{
-			debug(LOG_FATAL, "jsondiff file \"%s\" could not be opened!", name.toUtf8().c_str());
-		}
+	for (const JSON_SOURCE_FILE &diff : diffs)
+	{
 		nlohmann::json tmpJson;
 		try {
-			tmpJson = nlohmann::json::parse(data, data + size);
+			tmpJson = nlohmann::json::parse(diff.data);
 		}
 		catch (const std::exception &e) {
 			ASSERT(false, "JSON diff from %s is invalid: %s", name.toUtf8().c_str(), e.what());
@@ -136,12 +312,14 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 			debug(LOG_FATAL, "Unexpected exception parsing JSON diff from %s", name.toUtf8().c_str());
 		}
 		ASSERT(!tmpJson.is_null(), "JSON diff from %s is null", name.toUtf8().c_str());
-		ASSERT(tmpJson.is_object(), "JSON diff from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
+		ASSERT(tmpJson.is_object(), "JSON diff from %s is not an object. Read: \n%s", name.toUtf8().c_str(), diff.data.c_str());
 		mRoot = jsonMerge(mRoot, tmpJson);
-		free(data);
-		debug(LOG_INFO, "jsondiff \"%s\" loaded and merged", str.c_str());
-		return true; // continue
-	});
+		debug(LOG_INFO, "jsondiff \"%s\" loaded and merged", diff.fileName.c_str());
+	}
+	if (useCache)
+	{
+		jsonCache[name.toUtf8()] = JSON_CACHE_ENTRY{cacheKey, mRoot};
+	}
 	debug(LOG_SAVE, "Opening %s", name.toUtf8().c_str());
 	pCurrentObj = &mRoot;
 }
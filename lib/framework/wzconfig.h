@@ -165,6 +165,18 @@ public:
 	std::string compactStringRepresentation(const bool ensure_ascii = false) const;
 };
 
+/// Write a JSON document to a file, in the same layout WzConfig uses. If a batch is open, the document is
+/// only queued, and written later by the background writer.
+bool saveJSONToFile(nlohmann::json root, const char *pFileName);
+/// Queue the documents of saveJSONToFile() and of writable WzConfig objects, instead of writing them immediately.
+void saveJSONBatchBegin();
+/// Hand the queued documents to a background thread, which formats and writes them. Returns immediately.
+void saveJSONBatchEnd();
+/// Wait until the background writer is done. Returns false if any file of the last batch failed to save.
+bool saveJSONWaitForWrites();
+/// Forget the parsed game data files kept by WzConfig::ReadOnlyAndRequired, so that they are parsed again when next opened.
+void jsonCacheClear();
+
 // Enable JSON support for custom types
 
 // WzString
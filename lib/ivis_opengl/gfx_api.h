@@ -363,6 +363,9 @@ namespace gfx_api
 	template<SHADER_MODE T>
 	struct constant_buffer_type {};
 
+	/// Called before any pipeline is bound, so that draws held back for batching are issued first, in order.
+	extern void (*flushBatchedDraws)();
+
 	template<typename rasterizer, primitive_type primitive, index_type index, typename vertex_buffer_inputs, typename texture_inputs, SHADER_MODE shader>
 	struct pipeline_state_helper
 	{
@@ -376,6 +379,10 @@ namespace gfx_api
 
 		void bind()
 		{
+			if (flushBatchedDraws != nullptr)
+			{
+				flushBatchedDraws();
+			}
 			gfx_api::context::get().bind_pipeline(pso, std::tuple_size<texture_inputs>::value == 0);
 		}
 
@@ -707,6 +714,9 @@ namespace gfx_api
 	using RadarPSO = GFX<REND_ALPHA, DEPTH_CMP_ALWAYS_WRT_OFF, primitive_type::triangle_strip, gfx_vtx2, gfx_tc, SHADER_GFX_TEXT, std::tuple<texture_description<0, gfx_api::sampler_type::nearest_clamped>>>;
 	using RadarViewInsideFillPSO = GFX<REND_ALPHA, DEPTH_CMP_ALWAYS_WRT_OFF, primitive_type::triangle_strip, gfx_vtx2, gfx_colour, SHADER_GFX_COLOUR, notexture>;
 	using RadarViewOutlinePSO = GFX<REND_ALPHA, DEPTH_CMP_ALWAYS_WRT_OFF, primitive_type::line_strip, gfx_vtx2, gfx_colour, SHADER_GFX_COLOUR, notexture>;
+	using Batch2DColourPSO = GFX<REND_ALPHA, DEPTH_CMP_ALWAYS_WRT_OFF, primitive_type::triangles, gfx_vtx2, gfx_colour, SHADER_GFX_COLOUR, notexture>;
+	using Batch2DLinePSO = GFX<REND_ALPHA, DEPTH_CMP_ALWAYS_WRT_OFF, primitive_type::lines, gfx_vtx2, gfx_colour, SHADER_GFX_COLOUR, notexture>;
+	using Batch2DImagePSO = GFX<REND_ALPHA, DEPTH_CMP_ALWAYS_WRT_OFF, primitive_type::triangles, gfx_vtx2, gfx_tc, SHADER_GFX_TEXT, std::tuple<texture_description<0, gfx_api::sampler_type::bilinear>>>;
 
 	template<>
 	struct constant_buffer_type<SHADER_TEXT>
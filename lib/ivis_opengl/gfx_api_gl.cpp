@@ -48,6 +48,7 @@ OPENGL_DATA opengl;
 
 static GLuint perfpos[PERF_COUNT];
 static bool perfStarted = false;
+static bool mapBufferRangeAvailable = false;
 
 static std::pair<GLenum, GLenum> to_gl(const gfx_api::pixel_format& format)
 {
@@ -210,6 +211,22 @@ unsigned gl_texture::id()
 	return _id;
 }
 
+/// Write to a range of the buffer bound to target. If unsynchronized, the range must not be in use by the GPU.
+static void writeBufferRange(GLenum target, size_t offset, size_t size, const void *data, bool unsynchronized)
+{
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | (unsynchronized ? GL_MAP_UNSYNCHRONIZED_BIT : 0);
+	void *mapped = unsynchronized && mapBufferRangeAvailable ? glMapBufferRange(target, offset, size, access) : nullptr;
+	if (mapped != nullptr)
+	{
+		memcpy(mapped, data, size);
+		if (glUnmapBuffer(target))
+		{
+			return;
+		}
+	}
+	glBufferSubData(target, offset, size, data);
+}
+
 // MARK: gl_buffer
 
 gl_buffer::gl_buffer(const gfx_api::buffer::usage& usage, const gfx_api::context::buffer_storage_hint& hint)
@@ -247,6 +264,14 @@ void gl_buffer::upload(const size_t & size, const void * data)
 	glBufferData(to_gl(usage), size, data, to_gl(hint));
 	buffer_size = size;
 	glBindBuffer(to_gl(usage), 0);
+	ranges.respecified(size);
+	lastOrphaned_FrameNum = current_FrameNum;
+	if (hint == gfx_api::context::buffer_storage_hint::dynamic_draw)
+	{
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+		contents.assign(bytes, bytes + (data != nullptr ? size : 0));
+		contents.resize(size);
+	}
 }
 
 void gl_buffer::update(const size_t & start, const size_t & size, const void * data, const update_flag flag)
@@ -265,7 +290,36 @@ void gl_buffer::update(const size_t & start, const size_t & size, const void * d
 		return;
 	}
 	glBindBuffer(to_gl(usage), buffer);
-	glBufferSubData(to_gl(usage), start, size, data);
+	switch (hint)
+	{
+	case gfx_api::context::buffer_storage_hint::stream_draw:
+		// Stream buffers are written front to back each time they are reused. Starting over at a
+		// lower offset orphans the buffer, so earlier draws keep their data and this write never waits.
+		if (ranges.claim(start, size).orphan)
+		{
+			glBufferData(to_gl(usage), buffer_size, nullptr, to_gl(hint));
+		}
+		writeBufferRange(to_gl(usage), start, size, data, true);
+		break;
+	case gfx_api::context::buffer_storage_hint::dynamic_draw:
+		// Dynamic buffers keep their contents, so the first update in a frame respecifies the whole
+		// buffer from our copy instead of waiting for earlier draws. Later updates in the frame write
+		// to storage no earlier frame uses.
+		memcpy(&contents[start], data, size);
+		if (lastOrphaned_FrameNum != current_FrameNum)
+		{
+			lastOrphaned_FrameNum = current_FrameNum;
+			glBufferData(to_gl(usage), buffer_size, contents.data(), to_gl(hint));
+		}
+		else
+		{
+			writeBufferRange(to_gl(usage), start, size, data, true);
+		}
+		break;
+	default:
+		writeBufferRange(to_gl(usage), start, size, data, false);
+		break;
+	}
 	glBindBuffer(to_gl(usage), 0);
 }
 
@@ -1374,18 +1428,19 @@ void gl_context::bind_streamed_vertex_buffers(const void* data, const std::size_
 {
 	ASSERT_OR_RETURN(, current_program != nullptr, "current_program == NULL");
 	ASSERT(size > 0, "bind_streamed_vertex_buffers called with size 0");
+	const auto& buffer_desc = current_program->vertex_buffer_desc[0];
+	const gl_stream_allocator::allocation allocation = scratchbufferAllocator.allocate(size, 16);
 	glBindBuffer(GL_ARRAY_BUFFER, scratchbuffer);
-	if (scratchbuffer_size > 0)
+	if (allocation.orphan)
 	{
-		glBufferData(GL_ARRAY_BUFFER, scratchbuffer_size, nullptr, GL_STREAM_DRAW); // orphan previous buffer
+		glBufferData(GL_ARRAY_BUFFER, scratchbufferAllocator.capacity(), nullptr, GL_STREAM_DRAW); // orphan previous buffer
 	}
-	glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
-	scratchbuffer_size = size;
-	const auto& buffer_desc = current_program->vertex_buffer_desc[0];
+	// Only ranges written since the last orphan are in use, so the driver need not wait for the GPU.
+	writeBufferRange(GL_ARRAY_BUFFER, allocation.offset, size, data, true);
 	for (const auto& attribute : buffer_desc.attributes)
 	{
 		enableVertexAttribArray(static_cast<GLuint>(attribute.id));
-		glVertexAttribPointer(static_cast<GLuint>(attribute.id), get_size(attribute.type), get_type(attribute.type), get_normalisation(attribute.type), static_cast<GLsizei>(buffer_desc.stride), nullptr);
+		glVertexAttribPointer(static_cast<GLuint>(attribute.id), get_size(attribute.type), get_type(attribute.type), get_normalisation(attribute.type), static_cast<GLsizei>(buffer_desc.stride), reinterpret_cast<void*>(attribute.offset + allocation.offset));
 	}
 }
 
@@ -2044,6 +2099,10 @@ bool gl_context::initGLContext()
 	}
 
 	glGenBuffers(1, &scratchbuffer);
+	scratchbufferAllocator.reset();
+	// glMapBufferRange is core in OpenGL 3.0; the OpenGL ES 2.0 path uses glBufferSubData.
+	mapBufferRangeAvailable = GLAD_GL_VERSION_3_0 && glMapBufferRange && glUnmapBuffer;
+	debug(LOG_3D, "  * Streamed vertex data is written with %s", mapBufferRangeAvailable ? "glMapBufferRange" : "glBufferSubData");
 
 	return true;
 }
@@ -2091,6 +2150,7 @@ void gl_context::shutdown()
 	{
 		glDeleteBuffers(1, &scratchbuffer);
 		scratchbuffer = 0;
+		scratchbufferAllocator.reset();
 	}
 }
 
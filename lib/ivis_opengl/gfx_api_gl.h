@@ -20,6 +20,7 @@
 #pragma once
 
 #include "gfx_api.h"
+#include "gl_stream_allocator.h"
 
 #include <glad/glad.h>
 #include <algorithm>
@@ -74,6 +75,9 @@ struct gl_buffer final : public gfx_api::buffer
 	GLuint buffer = 0;
 	size_t buffer_size = 0;
 	size_t lastUploaded_FrameNum = 0;
+	gl_stream_allocator ranges = gl_stream_allocator(0);	///< Ranges of a stream_draw buffer written since it was last orphaned
+	std::vector<uint8_t> contents;	///< Copy of a dynamic_draw buffer, to respecify it from when it is updated
+	size_t lastOrphaned_FrameNum = 0;
 
 public:
 	gl_buffer(const gfx_api::buffer::usage& usage, const gfx_api::context::buffer_storage_hint& hint);
@@ -186,7 +190,7 @@ struct gl_context final : public gfx_api::context
 
 	gl_pipeline_state_object* current_program = nullptr;
 	GLuint scratchbuffer = 0;
-	size_t scratchbuffer_size = 0;
+	gl_stream_allocator scratchbufferAllocator = gl_stream_allocator(4 * 1024 * 1024);
 	bool khr_debug = false;
 
 	bool gles = false;
@@ -20,12 +20,65 @@
 #include "lib/framework/frame.h"
 #include "gfx_api_null.h"
 #include "lib/exceptionhandler/dumpinfo.h"
+#include "lib/framework/physfs_ext.h"
+
+static std::string statsFileName;
+
+void gfx_api::setNullBackendStatsFile(const std::string &fileName)
+{
+	statsFileName = fileName;
+}
+
+static size_t formatSize(const gfx_api::pixel_format &format)
+{
+	switch (format)
+	{
+		case gfx_api::pixel_format::FORMAT_RGBA8_UNORM_PACK8:
+		case gfx_api::pixel_format::FORMAT_BGRA8_UNORM_PACK8:
+			return 4;
+		case gfx_api::pixel_format::FORMAT_RGB8_UNORM_PACK8:
+			return 3;
+		case gfx_api::pixel_format::invalid:
+			break;
+	}
+	return 0;
+}
+
+// MARK: null_frame_stats
+
+void null_frame_stats::add(const null_frame_stats &other)
+{
+	draws += other.draws;
+	indexedDraws += other.indexedDraws;
+	elements += other.elements;
+	for (size_t i = 0; i < drawsPerPrimitive.size(); ++i)
+	{
+		drawsPerPrimitive[i] += other.drawsPerPrimitive[i];
+	}
+	for (size_t i = 0; i < drawsPerShader.size(); ++i)
+	{
+		drawsPerShader[i] += other.drawsPerShader[i];
+	}
+	pipelineBinds += other.pipelineBinds;
+	textureBinds += other.textureBinds;
+	constantUploads += other.constantUploads;
+	constantBytes += other.constantBytes;
+	bufferUploads += other.bufferUploads;
+	bufferBytes += other.bufferBytes;
+	streamedVertexBytes += other.streamedVertexBytes;
+	textureUploads += other.textureUploads;
+	textureBytes += other.textureBytes;
+	buffersCreated += other.buffersCreated;
+	texturesCreated += other.texturesCreated;
+	pipelinesBuilt += other.pipelinesBuilt;
+}
 
 // MARK: null_texture
 
-null_texture::null_texture()
+null_texture::null_texture(null_frame_stats &stats)
+: stats(stats)
 {
-	// no-op
+	++stats.texturesCreated;
 }
 
 null_texture::~null_texture()
@@ -41,12 +94,14 @@ void null_texture::bind()
 void null_texture::upload(const size_t& mip_level, const size_t& offset_x, const size_t& offset_y, const size_t & width, const size_t & height, const gfx_api::pixel_format & buffer_format, const void * data)
 {
 	ASSERT(width > 0 && height > 0, "Attempt to upload texture with width or height of 0 (width: %zu, height: %zu)", width, height);
-	// no-op
+	++stats.textureUploads;
+	stats.textureBytes += width * height * formatSize(buffer_format);
 }
 
 void null_texture::upload_and_generate_mipmaps(const size_t& offset_x, const size_t& offset_y, const size_t& width, const size_t& height, const  gfx_api::pixel_format& buffer_format, const void* data)
 {
-	// no-op
+	++stats.textureUploads;
+	stats.textureBytes += width * height * formatSize(buffer_format);
 }
 
 unsigned null_texture::id()
@@ -56,11 +111,12 @@ unsigned null_texture::id()
 
 // MARK: null_buffer
 
-null_buffer::null_buffer(const gfx_api::buffer::usage& usage, const gfx_api::context::buffer_storage_hint& hint)
+null_buffer::null_buffer(const gfx_api::buffer::usage& usage, const gfx_api::context::buffer_storage_hint& hint, null_frame_stats &stats)
 : usage(usage)
 , hint(hint)
+, stats(stats)
 {
-	// no-op
+	++stats.buffersCreated;
 }
 
 null_buffer::~null_buffer()
@@ -83,7 +139,8 @@ void null_buffer::upload(const size_t & size, const void * data)
 
 	ASSERT(size > 0, "Attempt to upload buffer of size 0");
 	buffer_size = size;
-	// no-op
+	++stats.bufferUploads;
+	stats.bufferBytes += size;
 }
 
 void null_buffer::update(const size_t & start, const size_t & size, const void * data, const update_flag flag)
@@ -101,13 +158,14 @@ void null_buffer::update(const size_t & start, const size_t & size, const void *
 		debug(LOG_WARNING, "Attempt to update buffer with 0 bytes of new data");
 		return;
 	}
-	// no-op
+	++stats.bufferUploads;
+	stats.bufferBytes += size;
 }
 
 // MARK: null_pipeline_state_object
 
-null_pipeline_state_object::null_pipeline_state_object(const gfx_api::state_description& _desc, const std::vector<gfx_api::vertex_buffer>& _vertex_buffer_desc)
-: desc(_desc), vertex_buffer_desc(_vertex_buffer_desc)
+null_pipeline_state_object::null_pipeline_state_object(const gfx_api::state_description& _desc, const SHADER_MODE& _shader_mode, const std::vector<gfx_api::vertex_buffer>& _vertex_buffer_desc)
+: desc(_desc), shader_mode(_shader_mode), vertex_buffer_desc(_vertex_buffer_desc)
 {
 	// no-op
 }
@@ -121,13 +179,13 @@ null_context::~null_context()
 
 gfx_api::texture* null_context::create_texture(const size_t& mipmap_count, const size_t & width, const size_t & height, const gfx_api::pixel_format & internal_format, const std::string& filename)
 {
-	auto* new_texture = new null_texture();
+	auto* new_texture = new null_texture(frameStats);
 	return new_texture;
 }
 
 gfx_api::buffer * null_context::create_buffer_object(const gfx_api::buffer::usage &usage, const buffer_storage_hint& hint /*= buffer_storage_hint::static_draw*/)
 {
-	return new null_buffer(usage, hint);
+	return new null_buffer(usage, hint, frameStats);
 }
 
 gfx_api::pipeline_state_object * null_context::build_pipeline(const gfx_api::state_description &state_desc,
@@ -136,7 +194,8 @@ gfx_api::pipeline_state_object * null_context::build_pipeline(const gfx_api::sta
 															const std::vector<gfx_api::texture_input>& texture_desc,
 															const std::vector<gfx_api::vertex_buffer>& attribute_descriptions)
 {
-	return new null_pipeline_state_object(state_desc, attribute_descriptions);
+	++frameStats.pipelinesBuilt;
+	return new null_pipeline_state_object(state_desc, shader_mode, attribute_descriptions);
 }
 
 void null_context::bind_pipeline(gfx_api::pipeline_state_object* pso, bool notextures)
@@ -145,6 +204,7 @@ void null_context::bind_pipeline(gfx_api::pipeline_state_object* pso, bool notex
 	if (current_program != new_program)
 	{
 		current_program = new_program;
+		++frameStats.pipelineBinds;
 	}
 }
 
@@ -178,7 +238,7 @@ void null_context::bind_streamed_vertex_buffers(const void* data, const std::siz
 {
 	ASSERT_OR_RETURN(, current_program != nullptr, "current_program == NULL");
 	ASSERT(size > 0, "bind_streamed_vertex_buffers called with size 0");
-	// no-op
+	frameStats.streamedVertexBytes += size;
 }
 
 void null_context::bind_index_buffer(gfx_api::buffer& _buffer, const gfx_api::index_type&)
@@ -198,23 +258,36 @@ void null_context::bind_textures(const std::vector<gfx_api::texture_input>& text
 {
 	ASSERT_OR_RETURN(, current_program != nullptr, "current_program == NULL");
 	ASSERT(textures.size() <= texture_descriptions.size(), "Received more textures than expected");
-	// no-op
+	frameStats.textureBinds += textures.size();
 }
 
 void null_context::set_constants(const void* buffer, const size_t& size)
 {
 	ASSERT_OR_RETURN(, current_program != nullptr, "current_program == NULL");
-	// no-op
+	++frameStats.constantUploads;
+	frameStats.constantBytes += size;
+}
+
+void null_context::recordDraw(const size_t &count, const gfx_api::primitive_type &primitive)
+{
+	++frameStats.draws;
+	frameStats.elements += count;
+	++frameStats.drawsPerPrimitive[static_cast<size_t>(primitive)];
+	if (current_program != nullptr)
+	{
+		++frameStats.drawsPerShader[current_program->shader_mode];
+	}
 }
 
 void null_context::draw(const size_t& offset, const size_t &count, const gfx_api::primitive_type &primitive)
 {
-	// no-op
+	recordDraw(count, primitive);
 }
 
 void null_context::draw_elements(const size_t& offset, const size_t &count, const gfx_api::primitive_type &primitive, const gfx_api::index_type& index)
 {
-	// no-op
+	recordDraw(count, primitive);
+	++frameStats.indexedDraws;
 }
 
 void null_context::set_polygon_offset(const float& offset, const float& slope)
@@ -326,11 +399,47 @@ bool null_context::_initialize(const gfx_api::backend_Impl_Factory& impl, int32_
 		setSwapInterval(gfx_api::context::swap_interval_mode::vsync);
 	}
 
+	if (!statsFileName.empty())
+	{
+		statsFile = PHYSFS_openWrite(statsFileName.c_str());
+		if (statsFile == nullptr)
+		{
+			debug(LOG_ERROR, "Could not open %s to record frame statistics: %s", statsFileName.c_str(), WZ_PHYSFS_getLastError());
+		}
+		else
+		{
+			static const char header[] = "frame,draws,indexed_draws,elements,lines,line_strips,triangles,triangle_strips,pipeline_binds,texture_binds,"
+				"constant_uploads,constant_bytes,buffer_uploads,buffer_bytes,streamed_vertex_bytes,texture_uploads,texture_bytes,"
+				"buffers_created,textures_created,pipelines_built\n";
+			WZ_PHYSFS_writeBytes(statsFile, header, sizeof(header) - 1);
+		}
+	}
+
 	return true;
 }
 
+void null_context::writeFrameStats()
+{
+	if (statsFile == nullptr)
+	{
+		return;
+	}
+	const null_frame_stats &s = frameStats;
+	char line[512];
+	int len = snprintf(line, sizeof(line), "%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu\n",
+		frameNum, s.draws, s.indexedDraws, s.elements,
+		s.drawsPerPrimitive[0], s.drawsPerPrimitive[1], s.drawsPerPrimitive[2], s.drawsPerPrimitive[3],
+		s.pipelineBinds, s.textureBinds, s.constantUploads, s.constantBytes, s.bufferUploads, s.bufferBytes,
+		s.streamedVertexBytes, s.textureUploads, s.textureBytes, s.buffersCreated, s.texturesCreated, s.pipelinesBuilt);
+	ASSERT_OR_RETURN(, len > 0 && (size_t)len < sizeof(line), "Frame statistics line too long");
+	WZ_PHYSFS_writeBytes(statsFile, line, len);
+}
+
 void null_context::flip(int clearMode)
 {
+	writeFrameStats();
+	totalStats.add(frameStats);
+	frameStats = null_frame_stats();
 	frameNum = std::max<size_t>(frameNum + 1, 1);
 
 	// Backend is expected to handle throttling / sleeping
@@ -346,7 +455,24 @@ void null_context::handleWindowSizeChange(unsigned int oldWidth, unsigned int ol
 
 void null_context::shutdown()
 {
-	// no-op
+	if (statsFile != nullptr)
+	{
+		PHYSFS_close(statsFile);
+		statsFile = nullptr;
+	}
+	if (frameNum > 0 && totalStats.draws > 0)
+	{
+		debug(LOG_INFO, "Null backend: %zu frames, %zu draws (%.1f per frame), %zu pipeline binds, %zu buffer uploads (%zu bytes), %zu texture uploads (%zu bytes)",
+		      frameNum, totalStats.draws, (double)totalStats.draws / frameNum, totalStats.pipelineBinds,
+		      totalStats.bufferUploads, totalStats.bufferBytes, totalStats.textureUploads, totalStats.textureBytes);
+		for (int shader = SHADER_NONE; shader < SHADER_MAX; ++shader)
+		{
+			if (totalStats.drawsPerShader[shader] > 0)
+			{
+				debug(LOG_INFO, "Null backend: shader %d: %zu draws", shader, totalStats.drawsPerShader[shader]);
+			}
+		}
+	}
 }
 
 const size_t& null_context::current_FrameNum() const
@@ -21,8 +21,15 @@
 
 #include "gfx_api.h"
 
+#include <array>
+#include <physfs.h>
+
 namespace gfx_api
 {
+	/// Record the draw statistics of each frame drawn by the null backend to fileName (in the write directory), as CSV.
+	/// Must be called before the backend is initialized. An empty fileName disables recording.
+	void setNullBackendStatsFile(const std::string &fileName);
+
 	class backend_Null_Impl
 	{
 	public:
@@ -36,12 +43,38 @@ namespace gfx_api
 	};
 }
 
+/// What the null backend was asked to do during one frame.
+struct null_frame_stats
+{
+	size_t draws = 0;               ///< draw() and draw_elements() calls
+	size_t indexedDraws = 0;        ///< draw_elements() calls
+	size_t elements = 0;            ///< Vertices or indices drawn
+	std::array<size_t, 4> drawsPerPrimitive = {};	///< Indexed by gfx_api::primitive_type
+	std::array<size_t, SHADER_MAX> drawsPerShader = {};
+	size_t pipelineBinds = 0;       ///< bind_pipeline() calls that changed the pipeline
+	size_t textureBinds = 0;
+	size_t constantUploads = 0;
+	size_t constantBytes = 0;
+	size_t bufferUploads = 0;       ///< upload() and update() calls
+	size_t bufferBytes = 0;
+	size_t streamedVertexBytes = 0;
+	size_t textureUploads = 0;
+	size_t textureBytes = 0;
+	size_t buffersCreated = 0;
+	size_t texturesCreated = 0;
+	size_t pipelinesBuilt = 0;
+
+	void add(const null_frame_stats &other);
+};
+
 struct null_texture final : public gfx_api::texture
 {
 private:
 	friend struct null_context;
-	null_texture();
+	null_texture(null_frame_stats &stats);
 	virtual ~null_texture();
+
+	null_frame_stats &stats;
 public:
 	virtual void bind() override;
 	virtual void upload(const size_t& mip_level, const size_t& offset_x, const size_t& offset_y, const size_t & width, const size_t & height, const gfx_api::pixel_format & buffer_format, const void * data) override;
@@ -55,9 +88,10 @@ struct null_buffer final : public gfx_api::buffer
 	gfx_api::context::buffer_storage_hint hint;
 	size_t buffer_size = 0;
 	size_t lastUploaded_FrameNum = 0;
+	null_frame_stats &stats;
 
 public:
-	null_buffer(const gfx_api::buffer::usage& usage, const gfx_api::context::buffer_storage_hint& hint);
+	null_buffer(const gfx_api::buffer::usage& usage, const gfx_api::context::buffer_storage_hint& hint, null_frame_stats &stats);
 	virtual ~null_buffer() override;
 
 	void bind() override;
@@ -68,9 +102,10 @@ public:
 struct null_pipeline_state_object final : public gfx_api::pipeline_state_object
 {
 	gfx_api::state_description desc;
+	SHADER_MODE shader_mode;
 	std::vector<gfx_api::vertex_buffer> vertex_buffer_desc;
 
-	null_pipeline_state_object(const gfx_api::state_description& _desc, const std::vector<gfx_api::vertex_buffer>& vertex_buffer_desc);
+	null_pipeline_state_object(const gfx_api::state_description& _desc, const SHADER_MODE& shader_mode, const std::vector<gfx_api::vertex_buffer>& vertex_buffer_desc);
 };
 
 struct null_context final : public gfx_api::context
@@ -128,7 +163,14 @@ public:
 	virtual gfx_api::context::swap_interval_mode getSwapInterval() const override;
 private:
 	virtual bool _initialize(const gfx_api::backend_Impl_Factory& impl, int32_t antialiasing, swap_interval_mode mode) override;
+
+	void recordDraw(const size_t &count, const gfx_api::primitive_type &primitive);
+	void writeFrameStats();
 private:
 
 	size_t frameNum = 0;
+
+	null_frame_stats frameStats;   ///< Of the frame being drawn
+	null_frame_stats totalStats;   ///< Of all finished frames
+	PHYSFS_file *statsFile = nullptr;
 };
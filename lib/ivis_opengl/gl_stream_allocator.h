@@ -0,0 +1,100 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "lib/framework/frame.h"
+
+#include <cstddef>
+
+/// Suballocates streamed data from a ring buffer. When the ring is full, or a request does not fit,
+/// the allocation asks for the buffer to be orphaned and starts again at offset 0. Orphaning gives
+/// the buffer new storage, so data the GPU may still be reading is never overwritten, without fences.
+/// Does not call GL itself.
+struct gl_stream_allocator
+{
+	struct allocation
+	{
+		size_t offset;	///< Where to write the data.
+		bool orphan;	///< The buffer must be respecified with capacity() bytes before writing.
+	};
+
+	gl_stream_allocator(size_t initialCapacity) : ringCapacity(initialCapacity) {}
+
+	allocation allocate(size_t size, size_t alignment)
+	{
+		ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment %zu is not a power of 2", alignment);
+		ASSERT(ringCapacity > 0, "Allocating from an empty ring");
+		allocation result = {(head + alignment - 1) & ~(alignment - 1), !hasStorage};
+		if (size > ringCapacity)
+		{
+			while (ringCapacity < size)
+			{
+				ringCapacity *= 2;
+			}
+			result.offset = 0;
+			result.orphan = true;
+		}
+		else if (result.offset + size > ringCapacity)
+		{
+			result.offset = 0;
+			result.orphan = true;
+		}
+		head = result.offset + size;
+		hasStorage = true;
+		return result;
+	}
+
+	/// Claim a range whose offset the caller picked, for buffers whose users choose their own offsets.
+	/// Ranges must be claimed in increasing order: a range starting below the end of the last one
+	/// may overwrite data the GPU is still reading, so the buffer must be orphaned first.
+	allocation claim(size_t offset, size_t size)
+	{
+		ASSERT(offset + size <= ringCapacity, "Range %zu+%zu is past the end of the ring (%zu)", offset, size, ringCapacity);
+		allocation result = {offset, !hasStorage || offset < head};
+		head = offset + size;
+		hasStorage = true;
+		return result;
+	}
+
+	/// The buffer was given new storage of newCapacity bytes, with nothing written to it yet.
+	void respecified(size_t newCapacity)
+	{
+		ringCapacity = newCapacity;
+		head = 0;
+		hasStorage = true;
+	}
+
+	/// Forget the buffer storage, for when the buffer is deleted.
+	void reset()
+	{
+		head = 0;
+		hasStorage = false;
+	}
+
+	size_t capacity() const
+	{
+		return ringCapacity;
+	}
+
+private:
+	size_t ringCapacity;
+	size_t head = 0;
+	bool hasStorage = false;
+};
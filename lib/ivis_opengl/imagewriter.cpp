@@ -0,0 +1,205 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Encodes and writes images to disk on a background thread.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "imagewriter.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "3rdparty/stb_image_resize.h"
+
+#define IMAGE_WRITER_QUEUE_SIZE 4	///< Most images that may wait to be written at the same time
+
+struct ImageWriteJob
+{
+	std::string fileName;
+	std::unique_ptr<iV_Image> image;
+	IMGFileFormat format;
+	unsigned int maxSize;
+	IMGSaveCallback onSaved;
+	unsigned int generation;	///< writerGeneration when the job was queued
+};
+
+static std::deque<ImageWriteJob> writeJobs;	///< Protected by writerMutex
+static bool writerQuit = false;	///< Protected by writerMutex
+static WZ_MUTEX *writerMutex = nullptr;
+static WZ_SEMAPHORE *writerSemaphore = nullptr;	///< Posted once per queued job, and once to quit
+static WZ_THREAD *writerThread = nullptr;
+static unsigned int writerGeneration = 0;	///< Only used on the main thread. Bumped by iV_imageWriterShutdown(), so that results still queued for the main thread are dropped
+
+static void freeImage(std::unique_ptr<iV_Image> &image)
+{
+	if (image && image->bmp)
+	{
+		free(image->bmp);
+		image->bmp = nullptr;
+	}
+}
+
+/// Scale the image down to fit in maxSize x maxSize, keeping its aspect ratio.
+static IMGSaveError downscaleImage(iV_Image &image, unsigned int maxSize, int channels)
+{
+	if (image.width <= maxSize && image.height <= maxSize)
+	{
+		return IMGSaveError::None;
+	}
+	const float scale = std::min((float)maxSize / image.width, (float)maxSize / image.height);
+	const unsigned int newWidth = std::max(1u, (unsigned int)(image.width * scale));
+	const unsigned int newHeight = std::max(1u, (unsigned int)(image.height * scale));
+	unsigned char *newBmp = (unsigned char *)malloc((size_t)newWidth * newHeight * channels);
+	if (newBmp == nullptr)
+	{
+		return IMGSaveError("Couldn't allocate memory to scale down image");
+	}
+	if (!stbir_resize_uint8(image.bmp, image.width, image.height, 0, newBmp, newWidth, newHeight, 0, channels))
+	{
+		free(newBmp);
+		return IMGSaveError("Failed to scale down image");
+	}
+	free(image.bmp);
+	image.bmp = newBmp;
+	image.width = newWidth;
+	image.height = newHeight;
+	return IMGSaveError::None;
+}
+
+static IMGSaveError writeImage(ImageWriteJob &job)
+{
+	if (job.maxSize != 0)
+	{
+		IMGSaveError error = downscaleImage(*job.image, job.maxSize, job.format == IMGFileFormat::PNG_GRAY ? 1 : 3);
+		if (!error.noError())
+		{
+			return error;
+		}
+	}
+	switch (job.format)
+	{
+	case IMGFileFormat::PNG:
+		return iV_saveImage_PNG(job.fileName.c_str(), job.image.get());
+	case IMGFileFormat::PNG_GRAY:
+		return iV_saveImage_PNG_Gray(job.fileName.c_str(), job.image.get());
+	case IMGFileFormat::JPEG:
+		return iV_saveImage_JPEG(job.fileName.c_str(), job.image.get());
+	}
+	return IMGSaveError("Unknown image format");
+}
+
+/** This runs in a separate thread */
+static int imageWriterThreadFunc(void *)
+{
+	while (true)
+	{
+		wzSemaphoreWait(writerSemaphore);
+		wzMutexLock(writerMutex);
+		if (writeJobs.empty())
+		{
+			// Only the quit request posts without queueing a job, and it is posted after every job.
+			ASSERT(writerQuit, "Image writer woken without a job");
+			wzMutexUnlock(writerMutex);
+			break;
+		}
+		ImageWriteJob job = std::move(writeJobs.front());
+		writeJobs.pop_front();
+		wzMutexUnlock(writerMutex);
+
+		IMGSaveError error = writeImage(job);
+		freeImage(job.image);
+
+		// Report back on the main thread
+		std::string fileName = std::move(job.fileName);
+		IMGSaveCallback onSaved = std::move(job.onSaved);
+		const unsigned int generation = job.generation;
+		wzAsyncExecOnMainThread([fileName, error, onSaved, generation]
+			{
+				// If the writer was shut down since, whatever onSaved refers to may be gone.
+				if (onSaved && generation == writerGeneration)
+				{
+					onSaved(fileName, error);
+				}
+				else if (!error.noError())
+				{
+					debug(LOG_ERROR, "%s", error.text.c_str());
+				}
+			}
+		);
+	}
+	return 0;
+}
+
+bool iV_queueSaveImage(const std::string &fileName, std::unique_ptr<iV_Image> image, IMGFileFormat format, unsigned int maxSize, const IMGSaveCallback &onSaved)
+{
+	ASSERT_OR_RETURN(false, image && image->bmp, "No image to save to %s", fileName.c_str());
+
+	if (writerThread == nullptr)
+	{
+		writerQuit = false;
+		writerMutex = wzMutexCreate();
+		writerSemaphore = wzSemaphoreCreate(0);
+		writerThread = wzThreadCreate(imageWriterThreadFunc, nullptr);
+		if (writerThread == nullptr)
+		{
+			debug(LOG_ERROR, "Failed to create image writer thread");
+			wzSemaphoreDestroy(writerSemaphore);
+			wzMutexDestroy(writerMutex);
+			writerSemaphore = nullptr;
+			writerMutex = nullptr;
+			freeImage(image);
+			return false;
+		}
+		wzThreadStart(writerThread);
+	}
+
+	wzMutexLock(writerMutex);
+	if (writeJobs.size() >= IMAGE_WRITER_QUEUE_SIZE)
+	{
+		wzMutexUnlock(writerMutex);
+		debug(LOG_WARNING, "Too many images waiting to be written, not saving %s", fileName.c_str());
+		freeImage(image);
+		return false;
+	}
+	writeJobs.push_back(ImageWriteJob{fileName, std::move(image), format, maxSize, onSaved, writerGeneration});
+	wzMutexUnlock(writerMutex);
+	wzSemaphorePost(writerSemaphore);
+	return true;
+}
+
+void iV_imageWriterShutdown()
+{
+	if (writerThread == nullptr)
+	{
+		return;
+	}
+	wzMutexLock(writerMutex);
+	writerQuit = true;
+	wzMutexUnlock(writerMutex);
+	wzSemaphorePost(writerSemaphore);
+	wzThreadJoin(writerThread);  // Writes whatever is still queued first
+	++writerGeneration;  // Results not yet reported back are not reported at all
+	wzSemaphoreDestroy(writerSemaphore);
+	wzMutexDestroy(writerMutex);
+	writerThread = nullptr;
+	writerSemaphore = nullptr;
+	writerMutex = nullptr;
+}
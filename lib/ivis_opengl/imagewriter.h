@@ -0,0 +1,60 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Encodes and writes images to disk on a background thread.
+ */
+
+#ifndef _LIBIVIS_COMMON_IMAGEWRITER_H_
+#define _LIBIVIS_COMMON_IMAGEWRITER_H_
+
+#include "pietypes.h"
+#include "png_util.h"
+#include <functional>
+#include <memory>
+#include <string>
+
+enum class IMGFileFormat
+{
+	PNG,       ///< RGB PNG
+	PNG_GRAY,  ///< Grayscale PNG
+	JPEG,      ///< RGB JPEG, written with a .jpg extension
+};
+
+/// Called on the main thread after an image was written, or failed to be written.
+typedef std::function<void (const std::string &fileName, const IMGSaveError &error)> IMGSaveCallback;
+
+/*!
+ * Queue an image to be encoded and written to file on the image writer thread.
+ *
+ * Only a few images may wait at the same time, so that a burst of requests cannot
+ * use unbounded memory. Never waits for the writer. Must be called from the main thread.
+ *
+ * \param fileName output file to save to
+ * \param image image to write, whose bmp is freed with free() once written
+ * \param format file format to encode
+ * \param maxSize if not 0, the image is scaled down to fit in maxSize x maxSize
+ * \param onSaved optional callback, called on the main thread when done
+ * \return false if the queue is full, in which case the image is dropped
+ */
+bool iV_queueSaveImage(const std::string &fileName, std::unique_ptr<iV_Image> image, IMGFileFormat format, unsigned int maxSize = 0, const IMGSaveCallback &onSaved = nullptr);
+
+/// Write the images still in the queue, and stop the image writer thread. Callbacks not yet called are never called.
+void iV_imageWriterShutdown();
+
+#endif // _LIBIVIS_COMMON_IMAGEWRITER_H_
@@ -24,6 +24,8 @@
  * Load IMD (.pie) files
  */
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <unordered_map>
 
@@ -127,6 +129,59 @@ iIMDShape *modelGet(const WzString &filename)
 	return nullptr;
 }
 
+// sscanf() measures the length of the whole remaining file on every call, which makes reading the long number
+// lists of a model quadratic in the file size. These read the same numbers with strtof() and strtoul() instead.
+static bool ReadFloats(const char **ppFileData, float *values, int count)
+{
+	const char *pFileData = *ppFileData;
+	for (int i = 0; i < count; ++i)
+	{
+		char *end;
+		values[i] = strtof(pFileData, &end);
+		if (end == pFileData)
+		{
+			return false;
+		}
+		pFileData = end;
+	}
+	*ppFileData = pFileData;
+	return true;
+}
+
+static bool ReadUnsigned(const char **ppFileData, uint32_t *values, int count, int base = 10)
+{
+	const char *pFileData = *ppFileData;
+	for (int i = 0; i < count; ++i)
+	{
+		char *end;
+		values[i] = static_cast<uint32_t>(strtoul(pFileData, &end, base));
+		if (end == pFileData)
+		{
+			return false;
+		}
+		pFileData = end;
+	}
+	*ppFileData = pFileData;
+	return true;
+}
+
+static bool ReadInts(const char **ppFileData, int *values, int count)
+{
+	const char *pFileData = *ppFileData;
+	for (int i = 0; i < count; ++i)
+	{
+		char *end;
+		values[i] = static_cast<int>(strtol(pFileData, &end, 10));
+		if (end == pFileData)
+		{
+			return false;
+		}
+		pFileData = end;
+	}
+	*ppFileData = pFileData;
+	return true;
+}
+
 static bool AtEndOfFile(const char *CurPos, const char *EndOfFile)
 {
 	while (*CurPos == 0x00 || *CurPos == 0x09 || *CurPos == 0x0a || *CurPos == 0x0d || *CurPos == 0x20)
@@ -162,23 +217,21 @@ static bool _imd_load_polys(const WzString &filename, const char **ppFileData, i
 	for (unsigned i = 0; i < s->polys.size(); i++)
 	{
 		iIMDPoly *poly = &s->polys[i];
-		unsigned int flags, npnts;
-		int cnt;
+		uint32_t flags, npnts;
 
-		if (sscanf(pFileData, "%x %u%n", &flags, &npnts, &cnt) != 2)
+		if (!ReadUnsigned(&pFileData, &flags, 1, 16) || !ReadUnsigned(&pFileData, &npnts, 1))
 		{
 			debug(LOG_ERROR, "(_load_polys) [poly %u] error loading flags and npoints", i);
+			return false;
 		}
-		pFileData += cnt;
 
 		poly->flags = flags;
 		ASSERT_OR_RETURN(false, npnts == 3, "Invalid polygon size (%d)", npnts);
-		if (sscanf(pFileData, "%" PRIu32 "%" PRIu32 "%" PRIu32 "%n", &poly->pindex[0], &poly->pindex[1], &poly->pindex[2], &cnt) != 3)
+		if (!ReadUnsigned(&pFileData, poly->pindex, 3))
 		{
 			debug(LOG_ERROR, "failed reading triangle, point %d", i);
 			return false;
 		}
-		pFileData += cnt;
 
 		// sanity check
 		for (size_t pIdx = 0; pIdx < 3; pIdx++)
@@ -214,12 +267,17 @@ static bool _imd_load_polys(const WzString &filename, const char **ppFileData, i
 
 			if (poly->flags & iV_IMD_TEXANIM)
 			{
-				if (sscanf(pFileData, "%d %d %f %f%n", &nFrames, &pbRate, &tWidth, &tHeight, &cnt) != 4)
+				int anim[2];
+				float size[2];
+				if (!ReadInts(&pFileData, anim, 2) || !ReadFloats(&pFileData, size, 2))
 				{
 					debug(LOG_ERROR, "(_load_polys) [poly %u] error reading texanim data", i);
 					return false;
 				}
-				pFileData += cnt;
+				nFrames = anim[0];
+				pbRate = anim[1];
+				tWidth = size[0];
+				tHeight = size[1];
 
 				ASSERT(tWidth > 0.0001f, "%s: texture width = %f", filename.toUtf8().c_str(), tWidth);
 				ASSERT(tHeight > 0.f, "%s: texture height = %f (width=%f)", filename.toUtf8().c_str(), tHeight, tWidth);
@@ -266,14 +324,14 @@ static bool _imd_load_polys(const WzString &filename, const char **ppFileData, i
 			poly->texCoord.resize(nFrames * 3);
 			for (unsigned j = 0; j < 3; j++)
 			{
-				float VertexU, VertexV;
+				float uv[2];
 
-				if (sscanf(pFileData, "%f %f%n", &VertexU, &VertexV, &cnt) != 2)
+				if (!ReadFloats(&pFileData, uv, 2))
 				{
 					debug(LOG_ERROR, "(_load_polys) [poly %u] error reading tex outline", i);
 					return false;
 				}
-				pFileData += cnt;
+				float VertexU = uv[0], VertexV = uv[1];
 
 				if (pieVersion != PIE_FLOAT_VER)
 				{
@@ -308,16 +366,14 @@ static bool _imd_load_polys(const WzString &filename, const char **ppFileData, i
 static bool ReadPoints(const char **ppFileData, iIMDShape &s)
 {
 	const char *pFileData = *ppFileData;
-	int cnt;
 
 	for (Vector3f &points : s.points)
 	{
-		if (sscanf(pFileData, "%f %f %f%n", &points.x, &points.y, &points.z, &cnt) != 3)
+		if (!ReadFloats(&pFileData, &points.x, 3))
 		{
 			debug(LOG_ERROR, "File corrupt - could not read points");
 			return false;
 		}
-		pFileData += cnt;
 	}
 
 	*ppFileData = pFileData;
@@ -565,19 +621,47 @@ static std::vector<gfx_api::gfxFloat> bitangents;
 static std::vector<uint16_t> indices; // size is npolys * 3 * numFrames
 static uint16_t vertexCount = 0;
 
+/// Texture coordinate, position and normal of a vertex, for finding identical vertices.
+struct WeldKey
+{
+	float v[8];
+
+	bool operator ==(const WeldKey &b) const
+	{
+		return std::equal(v, v + 8, b.v);
+	}
+};
+
+struct WeldKeyHash
+{
+	size_t operator ()(const WeldKey &key) const
+	{
+		uint32_t hash = 0;
+		for (float f : key.v)
+		{
+			uint32_t bits;
+			f = f == 0.f ? 0.f : f;  // -0 and 0 are equal, so they must hash the same
+			memcpy(&bits, &f, sizeof(bits));
+			hash = (hash ^ bits) * 16777619u;
+		}
+		return hash;
+	}
+};
+
+/// First index of each distinct vertex of the level being loaded.
+static std::unordered_map<WeldKey, uint16_t, WeldKeyHash> weldedVertices;
+
 static bool ReadNormals(const char **ppFileData, std::vector<Vector3f> &pie_level_normals)
 {
    const char *pFileData = *ppFileData;
-   int dataCnt;
 
    for (Vector3f &normal : pie_level_normals)
    {
-	   if (sscanf(pFileData, "%f %f %f%n", &normal.x, &normal.y, &normal.z, &dataCnt) != 3)
+	   if (!ReadFloats(&pFileData, &normal.x, 3))
 	   {
 		   debug(LOG_ERROR, "File corrupt - could not read normals");
 		   return false;
 	   }
-	   pFileData += dataCnt;
    }
 
    *ppFileData = pFileData;
@@ -612,19 +696,16 @@ static inline uint16_t addVertex(iIMDShape &s, size_t i, const iIMDPoly *p, int
  	{
 		normal = &p->normal;
 		// See if we already have this defined, if so, return reference to it.
-		for (uint16_t j = 0; j < vertexCount; j++)
+		const Vector3f &point = s.points[p->pindex[i]];
+		const WeldKey key = {{p->texCoord[frame * 3 + i].x, p->texCoord[frame * 3 + i].y, point.x, point.y, point.z, normal->x, normal->y, normal->z}};
+		// NaN is never equal to anything, so such vertices are never welded
+		if (std::none_of(key.v, key.v + 8, [](float f) { return std::isnan(f); }))
 		{
-			if (texcoords[j * 2 + 0] == p->texCoord[frame * 3 + i].x
- 			    && texcoords[j * 2 + 1] == p->texCoord[frame * 3 + i].y
- 			    && vertices[j * 3 + 0] == s.points[p->pindex[i]].x
- 			    && vertices[j * 3 + 1] == s.points[p->pindex[i]].y
- 			    && vertices[j * 3 + 2] == s.points[p->pindex[i]].z
- 			    && normals[j * 3 + 0] == normal->x
- 			    && normals[j * 3 + 1] == normal->y
- 			    && normals[j * 3 + 2] == normal->z)
- 			{
- 				return j;
- 			}
+			auto it = weldedVertices.emplace(key, vertexCount);
+			if (!it.second)
+			{
+				return it.first->second;
+			}
 		}
 	}
 	else
@@ -856,15 +937,14 @@ static iIMDShape *_imd_load_level(const WzString &filename, const char **ppFileD
 			s.objanimdata.resize(s.objanimframes);
 			for (int i = 0; i < s.objanimframes; i++)
 			{
-				int frame;
-				Vector3i pos(0, 0, 0), rot(0, 0, 0);
+				int values[7] = {0, 0, 0, 0, 0, 0, 0};  // frame, position, rotation
 
-				if (sscanf(pFileData, "%d %d %d %d %d %d %d %f %f %f%n",
-				           &frame, &pos.x, &pos.y, &pos.z, &rot.x, &rot.y, &rot.z,
-				           &s.objanimdata[i].scale.x, &s.objanimdata[i].scale.y, &s.objanimdata[i].scale.z, &cnt) != 10)
+				if (!ReadInts(&pFileData, values, 7) || !ReadFloats(&pFileData, &s.objanimdata[i].scale.x, 3))
 				{
-					debug(LOG_ERROR, "%s: Invalid object animation level %d, line %d, frame %d", filename.toUtf8().c_str(), level, i, frame);
+					debug(LOG_ERROR, "%s: Invalid object animation level %d, line %d, frame %d", filename.toUtf8().c_str(), level, i, values[0]);
 				}
+				int frame = values[0];
+				Vector3i pos(values[1], values[2], values[3]), rot(values[4], values[5], values[6]);
 				ASSERT(frame == i, "%s: Invalid frame enumeration object animation (level %d) %d: %d", filename.toUtf8().c_str(), level, i, frame);
 				s.objanimdata[i].pos.x = pos.x / INT_SCALE;
 				s.objanimdata[i].pos.y = pos.z / INT_SCALE;
@@ -872,7 +952,6 @@ static iIMDShape *_imd_load_level(const WzString &filename, const char **ppFileD
 				s.objanimdata[i].rot.pitch = -(rot.x * DEG_1 / INT_SCALE);
 				s.objanimdata[i].rot.direction = -(rot.z * DEG_1 / INT_SCALE);
 				s.objanimdata[i].rot.roll = -(rot.y * DEG_1 / INT_SCALE);
-				pFileData += cnt;
 			}
 		}
 		else if (strcmp(buffer, "SHADOWPOINTS") == 0)
@@ -932,6 +1011,7 @@ static iIMDShape *_imd_load_level(const WzString &filename, const char **ppFileD
 
 	// FINALLY, massage the data into what can stream directly to OpenGL
 	vertexCount = 0;
+	weldedVertices.clear();
 	for (int k = 0; k < MAX(1, s.numFrames); k++)
 	{
 		// Go through all polygons for each frame
@@ -987,6 +1067,7 @@ static iIMDShape *_imd_load_level(const WzString &filename, const char **ppFileD
 	normals.resize(0);
 	tangents.resize(0);
 	bitangents.resize(0);
+	weldedVertices.clear();
 
 	*ppFileData = pFileData;
 
@@ -53,6 +53,44 @@
 /***************************************************************************/
 
 static GFX *radarGfx = nullptr;
+static size_t radarTexWidth = 0;
+
+/// Consecutive 2D draws that can be drawn with a single draw call.
+struct BATCH2D
+{
+	enum Kind
+	{
+		NONE,
+		COLOUR,	///< Filled triangles, coloured per vertex.
+		LINES,	///< Lines, coloured per vertex.
+		IMAGE	///< Textured triangles, all in the same colour.
+	};
+
+	Kind kind = NONE;
+	gfx_api::texture *texture = nullptr;
+	PIELIGHT colour;
+	glm::mat4 modelViewProjection;
+	std::vector<glm::vec2> positions;
+	std::vector<glm::vec2> texCoords;	///< For IMAGE.
+	std::vector<PIELIGHT> colours;	///< For COLOUR and LINES.
+};
+
+static BATCH2D batch2D;
+static bool batch2DFlushing = false;
+
+#define BATCH2D_BUFFER_SIZE (256 * 1024)
+
+// Vertex data of flushed batches. Every range of a buffer is written at most once per frame.
+static std::vector<gfx_api::buffer *> batch2DBuffers;
+static size_t batch2DBufferIndex = 0;
+static size_t batch2DBufferOffset = 0;
+static size_t batch2DBufferFrame = 0;
+
+static size_t batch2DDrawCount = 0;	///< Draw calls of flushed batches
+static size_t batch2DPrimitiveCount = 0;	///< Lines, rectangles and images drawn by them
+static size_t textDrawCount = 0;	///< Strings, which are drawn one call each
+
+/***************************************************************************/
 
 /***************************************************************************/
 /*
@@ -69,6 +107,165 @@ static Vector2i makePieImage(IMAGEFILE *imageFile, unsigned id, PIERECT *dest =
  */
 /***************************************************************************/
 
+/// Copies data to a range of a batch buffer that is not in use this frame. The buffers are stream buffers,
+/// which the OpenGL backend orphans when a range is written again in a later frame, instead of waiting.
+static std::tuple<gfx_api::buffer *, size_t> pie_Batch2DUpload(const void *data, size_t size)
+{
+	ASSERT(size <= BATCH2D_BUFFER_SIZE, "Batch too large: %zu bytes", size);
+	const size_t frame = gfx_api::context::get().current_FrameNum();
+	if (frame != batch2DBufferFrame)
+	{
+		batch2DBufferFrame = frame;
+		batch2DBufferIndex = 0;
+		batch2DBufferOffset = 0;
+	}
+	batch2DBufferOffset = (batch2DBufferOffset + 15) & ~size_t(15);
+	if (batch2DBufferOffset + size > BATCH2D_BUFFER_SIZE)
+	{
+		++batch2DBufferIndex;
+		batch2DBufferOffset = 0;
+	}
+	if (batch2DBufferIndex == batch2DBuffers.size())
+	{
+		gfx_api::buffer *buffer = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::stream_draw);
+		std::vector<uint8_t> zeroes(BATCH2D_BUFFER_SIZE, 0);
+		buffer->upload(BATCH2D_BUFFER_SIZE, zeroes.data());
+		batch2DBuffers.push_back(buffer);
+	}
+	gfx_api::buffer *buffer = batch2DBuffers[batch2DBufferIndex];
+	buffer->update(batch2DBufferOffset, size, data, gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+	size_t offset = batch2DBufferOffset;
+	batch2DBufferOffset += size;
+	return std::make_tuple(buffer, offset);
+}
+
+template<typename PSO, typename AUX>
+static void pie_Batch2DDraw(const std::vector<AUX> &aux)
+{
+	const auto positions = pie_Batch2DUpload(batch2D.positions.data(), batch2D.positions.size() * sizeof(glm::vec2));
+	const auto auxiliary = pie_Batch2DUpload(aux.data(), aux.size() * sizeof(AUX));
+	gfx_api::context::get().bind_vertex_buffers(0, { positions, auxiliary });
+	PSO::get().draw(batch2D.positions.size(), 0);
+	gfx_api::context::get().unbind_vertex_buffers(0, { positions, auxiliary });
+	++batch2DDrawCount;
+}
+
+/// Draws the batched 2D draws. Called before anything else is drawn, see gfx_api::flushBatchedDraws.
+void pie_FlushBatched2D()
+{
+	if (batch2D.kind == BATCH2D::NONE || batch2DFlushing)
+	{
+		return;
+	}
+	batch2DFlushing = true;
+	switch (batch2D.kind)
+	{
+	case BATCH2D::COLOUR:
+		gfx_api::Batch2DColourPSO::get().bind();
+		gfx_api::Batch2DColourPSO::get().bind_constants({ batch2D.modelViewProjection });
+		pie_Batch2DDraw<gfx_api::Batch2DColourPSO>(batch2D.colours);
+		break;
+	case BATCH2D::LINES:
+		gfx_api::Batch2DLinePSO::get().bind();
+		gfx_api::Batch2DLinePSO::get().bind_constants({ batch2D.modelViewProjection });
+		pie_Batch2DDraw<gfx_api::Batch2DLinePSO>(batch2D.colours);
+		break;
+	case BATCH2D::IMAGE:
+		gfx_api::Batch2DImagePSO::get().bind();
+		gfx_api::Batch2DImagePSO::get().bind_constants({ batch2D.modelViewProjection, glm::vec2(0.f), glm::vec2(0.f),
+			glm::vec4(batch2D.colour.vector[0] / 255.f, batch2D.colour.vector[1] / 255.f, batch2D.colour.vector[2] / 255.f, batch2D.colour.vector[3] / 255.f), 0 });
+		gfx_api::Batch2DImagePSO::get().bind_textures(batch2D.texture);
+		pie_Batch2DDraw<gfx_api::Batch2DImagePSO>(batch2D.texCoords);
+		break;
+	case BATCH2D::NONE:
+		break;
+	}
+	batch2D.kind = BATCH2D::NONE;
+	batch2D.positions.clear();
+	batch2D.texCoords.clear();
+	batch2D.colours.clear();
+	batch2DFlushing = false;
+}
+
+/// Starts a new batch, unless the draw can be added to the current one.
+static void pie_Batch2DBegin(BATCH2D::Kind kind, gfx_api::texture *texture, PIELIGHT colour, const glm::mat4 &modelViewProjection, size_t vertices)
+{
+	const size_t vertexSize = sizeof(glm::vec2) + (kind == BATCH2D::IMAGE ? sizeof(glm::vec2) : sizeof(PIELIGHT));
+	if (batch2D.kind != kind || batch2D.texture != texture || (kind == BATCH2D::IMAGE && batch2D.colour.rgba != colour.rgba)
+	    || batch2D.modelViewProjection != modelViewProjection || (batch2D.positions.size() + vertices) * vertexSize > BATCH2D_BUFFER_SIZE)
+	{
+		pie_FlushBatched2D();
+		gfx_api::flushBatchedDraws = pie_FlushBatched2D;
+		batch2D.kind = kind;
+		batch2D.texture = texture;
+		batch2D.colour = colour;
+		batch2D.modelViewProjection = modelViewProjection;
+	}
+	++batch2DPrimitiveCount;
+}
+
+/// Adds a rectangle from (x0, y0) to (x1, y1), with the corners in the same order as pie_internal::rectBuffer.
+static void pie_Batch2DRect(float x0, float y0, float x1, float y1)
+{
+	const glm::vec2 corners[4] = { glm::vec2(x0, y1), glm::vec2(x0, y0), glm::vec2(x1, y1), glm::vec2(x1, y0) };
+	// The two triangles of the triangle strip the unbatched draws use, with the same winding.
+	for (int corner : { 0, 1, 2, 2, 1, 3 })
+	{
+		batch2D.positions.push_back(corners[corner]);
+	}
+}
+
+static void pie_Batch2DColourRect(float x0, float y0, float x1, float y1, PIELIGHT colour, const glm::mat4 &modelViewProjection)
+{
+	pie_Batch2DBegin(BATCH2D::COLOUR, nullptr, colour, modelViewProjection, 6);
+	pie_Batch2DRect(x0, y0, x1, y1);
+	batch2D.colours.insert(batch2D.colours.end(), 6, colour);
+}
+
+static void pie_Batch2DLine(float x0, float y0, float x1, float y1, PIELIGHT colour, const glm::mat4 &modelViewProjection)
+{
+	pie_Batch2DBegin(BATCH2D::LINES, nullptr, colour, modelViewProjection, 2);
+	batch2D.positions.push_back(glm::vec2(x0, y0));
+	batch2D.positions.push_back(glm::vec2(x1, y1));
+	batch2D.colours.insert(batch2D.colours.end(), 2, colour);
+}
+
+/// Same as drawing with iv_DrawImageImpl<gfx_api::DrawImagePSO>.
+static void pie_Batch2DImage(gfx_api::texture &texture, Vector2f offset, Vector2f size, Vector2f TextureUV, Vector2f TextureSize, PIELIGHT colour, const glm::mat4 &modelViewProjection)
+{
+	pie_Batch2DBegin(BATCH2D::IMAGE, &texture, colour, modelViewProjection, 6);
+	pie_Batch2DRect(offset.x, offset.y, offset.x + size.x, offset.y + size.y);
+	const glm::vec2 corners[4] = { TextureUV + glm::vec2(0.f, TextureSize.y), TextureUV, TextureUV + TextureSize, TextureUV + glm::vec2(TextureSize.x, 0.f) };
+	for (int corner : { 0, 1, 2, 2, 1, 3 })
+	{
+		batch2D.texCoords.push_back(corners[corner]);
+	}
+}
+
+void pie_ShutdownBatched2D()
+{
+	batch2D = BATCH2D();
+	gfx_api::flushBatchedDraws = nullptr;
+	for (gfx_api::buffer *buffer : batch2DBuffers)
+	{
+		delete buffer;
+	}
+	batch2DBuffers.clear();
+	batch2DBufferIndex = 0;
+	batch2DBufferOffset = 0;
+}
+
+void pie_GetResetBatch2DCounts(size_t *pBatchDrawCount, size_t *pBatchedCount, size_t *pTextDrawCount)
+{
+	*pBatchDrawCount = batch2DDrawCount;
+	*pBatchedCount = batch2DPrimitiveCount;
+	*pTextDrawCount = textDrawCount;
+
+	batch2DDrawCount = 0;
+	batch2DPrimitiveCount = 0;
+	textDrawCount = 0;
+}
+
 GFX::GFX(GFXTYPE type, int coordsPerVertex) : mType(type), mCoordsPerVertex(coordsPerVertex), mSize(0)
 {
 }
@@ -121,6 +318,17 @@ void GFX::updateTexture(const void *image, size_t width, size_t height)
 	mTexture->upload(0u, 0u, 0u, width, height, mFormat, image);
 }
 
+void GFX::updateTextureRegion(const void *image, size_t offsetX, size_t offsetY, size_t width, size_t height)
+{
+	ASSERT(mType == GFX_TEXTURE, "Wrong GFX type");
+	ASSERT_OR_RETURN(, offsetX + width <= mWidth && offsetY + height <= mHeight, "Region (%zu,%zu)+(%zu,%zu) outside texture (%zu,%zu)", offsetX, offsetY, width, height, mWidth, mHeight);
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+	mTexture->upload(0u, offsetX, offsetY, width, height, mFormat, image);
+}
+
 void GFX::buffers(int vertices, const void *vertBuf, const void *auxBuf)
 {
 	if (!mBuffers[VBO_VERTEX])
@@ -155,37 +363,36 @@ GFX::~GFX()
 
 void iV_Line(int x0, int y0, int x1, int y1, PIELIGHT colour)
 {
-	const glm::vec4 color(
-		colour.vector[0] / 255.f,
-		colour.vector[1] / 255.f,
-		colour.vector[2] / 255.f,
-		colour.vector[3] / 255.f
-	);
-	const auto &mat = glm::ortho(0.f, static_cast<float>(pie_GetVideoBufferWidth()), static_cast<float>(pie_GetVideoBufferHeight()), 0.f);
-	gfx_api::LinePSO::get().bind();
-	gfx_api::LinePSO::get().bind_constants({ mat, glm::vec2(x0, y0), glm::vec2(x1, y1), color });
-	gfx_api::LinePSO::get().bind_vertex_buffers(pie_internal::rectBuffer);
-	gfx_api::LinePSO::get().draw(2, 0);
-	gfx_api::LinePSO::get().unbind_vertex_buffers(pie_internal::rectBuffer);
+	pie_Batch2DLine(x0, y0, x1, y1, colour, defaultProjectionMatrix());
 }
 
 void iV_Lines(const std::vector<glm::ivec4> &lines, PIELIGHT colour)
 {
-	const glm::vec4 color(
-		colour.vector[0] / 255.f,
-		colour.vector[1] / 255.f,
-		colour.vector[2] / 255.f,
-		colour.vector[3] / 255.f
-	);
-	const auto &mat = glm::ortho(0.f, static_cast<float>(pie_GetVideoBufferWidth()), static_cast<float>(pie_GetVideoBufferHeight()), 0.f);
-	gfx_api::LinePSO::get().bind();
-	gfx_api::LinePSO::get().bind_vertex_buffers(pie_internal::rectBuffer);
+	const glm::mat4 mat = defaultProjectionMatrix();
 	for (const auto &line : lines)
 	{
-		gfx_api::LinePSO::get().bind_constants({ mat, glm::vec2(line.x, line.y), glm::vec2(line.z, line.w), color });
-		gfx_api::LinePSO::get().draw(2, 0);
+		pie_Batch2DLine(line.x, line.y, line.z, line.w, colour, mat);
+	}
+}
+
+/**
+ *	Draws filled rectangle. Opaque rectangles ignore the alpha of colour.
+ */
+static void pie_DrawRect(float x0, float y0, float x1, float y1, PIELIGHT colour, bool opaque)
+{
+	if (x0 > x1)
+	{
+		std::swap(x0, x1);
+	}
+	if (y0 > y1)
+	{
+		std::swap(y0, y1);
+	}
+	if (opaque)
+	{
+		colour.byte.a = 255;
 	}
-	gfx_api::LinePSO::get().unbind_vertex_buffers(pie_internal::rectBuffer);
+	pie_Batch2DColourRect(x0, y0, x1, y1, colour, defaultProjectionMatrix());
 }
 
 /**
@@ -217,39 +424,15 @@ void pie_DrawMultiRect(std::vector<PIERECT_DrawRequest> rects)
 {
 	if (rects.empty()) { return; }
 
-	const auto projectionMatrix = defaultProjectionMatrix();
-	bool didEnableRect = false;
-	gfx_api::BoxFillPSO::get().bind();
-
-	for (auto it = rects.begin(); it != rects.end(); ++it)
+	for (const auto &rect : rects)
 	{
-		if (it->x0 > it->x1)
-		{
-			std::swap(it->x0, it->x1);
-		}
-		if (it->y0 > it->y1)
-		{
-			std::swap(it->y0, it->y1);
-		}
-		const auto& colour = it->color;
-		const auto& center = Vector2f(it->x0, it->y0);
-		const auto& mvp = projectionMatrix * glm::translate(Vector3f(center, 0.f)) * glm::scale(glm::vec3(it->x1 - it->x0, it->y1 - it->y0, 1.f));
-		gfx_api::BoxFillPSO::get().bind_constants({ mvp, glm::vec2(0.f), glm::vec2(0.f),
-			glm::vec4(colour.vector[0] / 255.f, colour.vector[1] / 255.f, colour.vector[2] / 255.f, colour.vector[3] / 255.f) });
-		if (!didEnableRect)
-		{
-			gfx_api::BoxFillPSO::get().bind_vertex_buffers(pie_internal::rectBuffer);
-			didEnableRect = true;
-		}
-
-		gfx_api::BoxFillPSO::get().draw(4, 0);
+		pie_DrawRect(rect.x0, rect.y0, rect.x1, rect.y1, rect.color, true);
 	}
-	gfx_api::BoxFillPSO::get().unbind_vertex_buffers(pie_internal::rectBuffer);
 }
 
 void iV_ShadowBox(int x0, int y0, int x1, int y1, int pad, PIELIGHT first, PIELIGHT second, PIELIGHT fill)
 {
-	pie_DrawRect<gfx_api::ShadowBox2DPSO>(x0 + pad, y0 + pad, x1 - pad, y1 - pad, fill);
+	pie_DrawRect(x0 + pad, y0 + pad, x1 - pad, y1 - pad, fill, true);
 	iV_Box2(x0, y0, x1, y1, first, second);
 }
 
@@ -257,38 +440,18 @@ void iV_ShadowBox(int x0, int y0, int x1, int y1, int pad, PIELIGHT first, PIELI
 
 void iV_Box2(int x0, int y0, int x1, int y1, PIELIGHT first, PIELIGHT second)
 {
-	const glm::mat4 mat = glm::ortho(0.f, static_cast<float>(pie_GetVideoBufferWidth()), static_cast<float>(pie_GetVideoBufferHeight()), 0.f);
-	const glm::vec4 firstColor(
-		first.vector[0] / 255.f,
-		first.vector[1] / 255.f,
-		first.vector[2] / 255.f,
-		first.vector[3] / 255.f
-	);
-	gfx_api::LinePSO::get().bind();
-	gfx_api::LinePSO::get().bind_vertex_buffers(pie_internal::rectBuffer);
-	gfx_api::LinePSO::get().bind_constants({ mat, glm::vec2(x0, y1), glm::vec2(x0, y0), firstColor });
-	gfx_api::LinePSO::get().draw(2, 0);
-	gfx_api::LinePSO::get().bind_constants({ mat, glm::vec2(x0, y0), glm::vec2(x1, y0), firstColor });
-	gfx_api::LinePSO::get().draw(2, 0);
-
-	const glm::vec4 secondColor(
-		second.vector[0] / 255.f,
-		second.vector[1] / 255.f,
-		second.vector[2] / 255.f,
-		second.vector[3] / 255.f
-	);
-	gfx_api::LinePSO::get().bind_constants({ mat, glm::vec2(x1, y0), glm::vec2(x1, y1), secondColor });
-	gfx_api::LinePSO::get().draw(2, 0);
-	gfx_api::LinePSO::get().bind_constants({ mat, glm::vec2(x0, y1), glm::vec2(x1, y1), secondColor });
-	gfx_api::LinePSO::get().draw(2, 0);
-	gfx_api::LinePSO::get().unbind_vertex_buffers(pie_internal::rectBuffer);
+	const glm::mat4 mat = defaultProjectionMatrix();
+	pie_Batch2DLine(x0, y1, x0, y0, first, mat);
+	pie_Batch2DLine(x0, y0, x1, y0, first, mat);
+	pie_Batch2DLine(x1, y0, x1, y1, second, mat);
+	pie_Batch2DLine(x0, y1, x1, y1, second, mat);
 }
 
 /***************************************************************************/
 
 void pie_BoxFill(int x0, int y0, int x1, int y1, PIELIGHT colour)
 {
-	pie_DrawRect<gfx_api::BoxFillPSO>(x0, y0, x1, y1, colour);
+	pie_DrawRect(x0, y0, x1, y1, colour, true);
 }
 
 void pie_BoxFill_alpha(int x0, int y0, int x1, int y1, PIELIGHT colour)
@@ -307,7 +470,7 @@ void iV_TransBoxFill(float x0, float y0, float x1, float y1)
 
 void pie_UniTransBoxFill(float x0, float y0, float x1, float y1, PIELIGHT light)
 {
-	pie_DrawRect<gfx_api::UniTransBoxPSO>(x0, y0, x1, y1, light);
+	pie_DrawRect(x0, y0, x1, y1, light, false);
 }
 
 /***************************************************************************/
@@ -347,6 +510,7 @@ void iV_DrawImageText(gfx_api::texture& TextureID, Vector2i Position, Vector2f o
 	glm::mat4 mvp = defaultProjectionMatrix() * glm::translate(glm::vec3(Position.x, Position.y, 0)) * glm::rotate(RADIANS(angle), glm::vec3(0.f, 0.f, 1.f));
 
 	iv_DrawImageImpl<gfx_api::DrawImageTextPSO>(TextureID, offset, size, Vector2f(0.f, 0.f), Vector2f(1.f, 1.f), colour, mvp, SHADER_TEXT);
+	++textDrawCount;
 }
 
 void iV_DrawImageTextClipped(gfx_api::texture& TextureID, Vector2i textureSize, Vector2i Position, Vector2f offset, Vector2f size, float angle, PIELIGHT colour, WzRect clippingRect)
@@ -361,6 +525,7 @@ void iV_DrawImageTextClipped(gfx_api::texture& TextureID, Vector2i textureSize,
 	float sv = (float)(clippingRect.y() + clippingRect.height()) * invTextureSizeY;
 
 	iv_DrawImageImpl<gfx_api::DrawImageTextPSO>(TextureID, offset, size, Vector2f(tu, tv), Vector2f(su, sv), colour, mvp, SHADER_TEXT);
+	++textDrawCount;
 }
 
 static void pie_DrawImage(IMAGEFILE *imageFile, int id, Vector2i size, const PIERECT *dest, PIELIGHT colour, const glm::mat4 &modelViewProjection, Vector2i textureInset = Vector2i(0, 0))
@@ -373,57 +538,15 @@ static void pie_DrawImage(IMAGEFILE *imageFile, int id, Vector2i size, const PIE
 	float su = (float)(size.x - (textureInset.x * 2)) * invTextureSize;
 	float sv = (float)(size.y - (textureInset.y * 2)) * invTextureSize;
 
-	glm::mat4 mvp = modelViewProjection * glm::translate(glm::vec3((float)dest->x, (float)dest->y, 0.f));
-
-	iv_DrawImageImpl<gfx_api::DrawImagePSO>(pie_Texture(texPage), Vector2i(0, 0), Vector2i(dest->w, dest->h), Vector2f(tu, tv), Vector2f(su, sv), colour, mvp);
+	pie_Batch2DImage(pie_Texture(texPage), Vector2f(dest->x, dest->y), Vector2f(dest->w, dest->h), Vector2f(tu, tv), Vector2f(su, sv), colour, modelViewProjection);
 }
 
 static void pie_DrawMultipleImages(const std::list<PieDrawImageRequest>& requests)
 {
-	if (requests.empty()) { return; }
-
-	bool didEnableRect = false;
-	gfx_api::DrawImagePSO::get().bind();
-	
 	for (auto& request : requests)
 	{
-		// The following is the equivalent of:
-		// pie_DrawImage(request.imageFile, request.ID, request.size, &request.dest, request.colour, request.modelViewProjection, request.textureInset)
-		// but is tweaked to use custom implementation of iv_DrawImageImpl that does not disable the shader after every glDrawArrays call.
-
-		ImageDef const &image2 = request.imageFile->imageDefs[request.ID];
-		size_t texPage = request.imageFile->pages[image2.TPageID].id;
-		gfx_api::gfxFloat invTextureSize = 1.f / (float)request.imageFile->pages[image2.TPageID].size;
-		float tu = (float)(image2.Tu + request.textureInset.x) * invTextureSize;
-		float tv = (float)(image2.Tv + request.textureInset.y) * invTextureSize;
-		float su = (float)(request.size.x - (request.textureInset.x * 2)) * invTextureSize;
-		float sv = (float)(request.size.y - (request.textureInset.y * 2)) * invTextureSize;
-
-		glm::mat4 mvp = request.modelViewProjection * glm::translate(glm::vec3((float)request.dest.x, (float)request.dest.y, 0.f));
-
-		gfx_api::texture& TextureID = pie_Texture(texPage);
-		Vector2f offset = Vector2f(0.f, 0.f);
-		Vector2f size = Vector2f(request.dest.w, request.dest.h);
-		Vector2f TextureUV = Vector2f(tu, tv);
-		Vector2f TextureSize = Vector2f(su, sv);
-		glm::mat4 transformMat = mvp * glm::translate(glm::vec3(offset.x, offset.y, 0.f)) * glm::scale(glm::vec3(size.x, size.y, 1.f));
-
-		gfx_api::DrawImagePSO::get().bind_constants({ transformMat,
-			TextureUV,
-			TextureSize,
-			glm::vec4(request.colour.vector[0] / 255.f, request.colour.vector[1] / 255.f, request.colour.vector[2] / 255.f, request.colour.vector[3] / 255.f), 0});
-
-		gfx_api::DrawImagePSO::get().bind_textures(&TextureID);
-
-		if (!didEnableRect)
-		{
-			gfx_api::DrawImagePSO::get().bind_vertex_buffers(pie_internal::rectBuffer);
-			didEnableRect = true;
-		}
-
-		gfx_api::DrawImagePSO::get().draw(4, 0);
+		pie_DrawImage(request.imageFile, request.ID, request.size, &request.dest, request.colour, request.modelViewProjection, request.textureInset);
 	}
-	gfx_api::DrawImagePSO::get().unbind_vertex_buffers(pie_internal::rectBuffer);
 }
 
 static Vector2i makePieImage(IMAGEFILE *imageFile, unsigned id, PIERECT *dest, int x, int y)
@@ -455,11 +578,10 @@ void iV_DrawImage2(const WzString &filename, float x, float y, float width, floa
 	x += image->XOffset;
 	y += image->YOffset;
 
-	glm::mat4 mvp = defaultProjectionMatrix() * glm::translate(glm::vec3(x, y, 0));
-	iv_DrawImageImpl<gfx_api::DrawImagePSO>(pie_Texture(image->textureId), Vector2i(0, 0), Vector2i(w, h),
+	pie_Batch2DImage(pie_Texture(image->textureId), Vector2f(x, y), Vector2f(w, h),
 		Vector2f(tu * invTextureSize, tv * invTextureSize),
 		Vector2f(image->Width * invTextureSize, image->Height * invTextureSize),
-		WZCOL_WHITE, mvp);
+		WZCOL_WHITE, defaultProjectionMatrix());
 }
 
 void iV_DrawImage(IMAGEFILE *ImageFile, UWORD ID, int x, int y, const glm::mat4 &modelViewProjection, BatchedImageDrawRequests* pBatchedRequests)
@@ -474,7 +596,6 @@ void iV_DrawImage(IMAGEFILE *ImageFile, UWORD ID, int x, int y, const glm::mat4
 
 	if (pBatchedRequests == nullptr)
 	{
-		gfx_api::DrawImagePSO::get().bind();
 		pie_DrawImage(ImageFile, ID, pieImage, &dest, WZCOL_WHITE, modelViewProjection);
 	}
 	else
@@ -495,8 +616,6 @@ void iV_DrawImageTc(Image image, Image imageTc, int x, int y, PIELIGHT colour, c
 	Vector2i pieImage   = makePieImage(image.images, image.id, &dest, x, y);
 	Vector2i pieImageTc = makePieImage(imageTc.images, imageTc.id);
 
-	gfx_api::DrawImagePSO::get().bind();
-
 	pie_DrawImage(image.images, image.id, pieImage, &dest, WZCOL_WHITE, modelViewProjection);
 	pie_DrawImage(imageTc.images, imageTc.id, pieImageTc, &dest, colour, modelViewProjection);
 }
@@ -604,6 +723,7 @@ bool pie_ShutdownRadar()
 void pie_SetRadar(gfx_api::gfxFloat x, gfx_api::gfxFloat y, gfx_api::gfxFloat width, gfx_api::gfxFloat height, size_t twidth, size_t theight)
 {
 	radarGfx->makeTexture(twidth, theight);
+	radarTexWidth = twidth;
 	//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);  // Want GL_LINEAR (or GL_LINEAR_MIPMAP_NEAREST) for min filter, but GL_NEAREST for mag filter. // TODO: Add a gfx_api::sampler_type to handle this case? bilinear, but nearest for mag?
 	gfx_api::gfxFloat texcoords[] = { 0.0f, 0.0f,  1.0f, 0.0f,  0.0f, 1.0f,  1.0f, 1.0f };
 	gfx_api::gfxFloat vertices[] = { x, y,  x + width, y,  x, y + height,  x + width, y + height };
@@ -616,6 +736,12 @@ void pie_DownLoadRadar(UDWORD *buffer)
 	radarGfx->updateTexture(buffer);
 }
 
+/** Store rows [firstRow, firstRow + numRows) of the radar texture. buffer is the whole radar image, not just the rows. */
+void pie_DownLoadRadarRows(UDWORD *buffer, size_t firstRow, size_t numRows)
+{
+	radarGfx->updateTextureRegion(buffer + firstRow * radarTexWidth, 0, firstRow, radarTexWidth, numRows);
+}
+
 /** Display radar texture using the given height and width, depending on zoom level. */
 void pie_RenderRadar(const glm::mat4 &modelViewProjectionMatrix)
 {
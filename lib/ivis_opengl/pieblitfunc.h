@@ -93,6 +93,9 @@ public:
 	/// Upload given memory buffer to already allocated texture space on the GPU
 	void updateTexture(const void *image, size_t width = 0, size_t height = 0);
 
+	/// Upload a tightly packed width x height memory buffer into the given region of the already allocated texture
+	void updateTextureRegion(const void *image, size_t offsetX, size_t offsetY, size_t width, size_t height);
+
 	/// Upload vertex and texture buffer data to the GPU
 	void buffers(int vertices, const void *vertBuf, const void *texBuf);
 
@@ -233,12 +236,21 @@ static inline void iV_DrawImageTc(IMAGEFILE *imageFile, unsigned id, unsigned id
 	iV_DrawImageTc(Image(imageFile, id), Image(imageFile, idTc), x, y, colour);
 }
 
+/// Draws the lines, rectangles and images that are held back to be drawn together. Happens automatically
+/// before any other pipeline is bound; needed before reading back the frame.
+void pie_FlushBatched2D();
+void pie_ShutdownBatched2D();
+/// Get and reset the number of batched draw calls, the lines, rectangles and images they drew,
+/// and the number of strings drawn, which are not batched since each has its own texture.
+void pie_GetResetBatch2DCounts(size_t *pBatchDrawCount, size_t *pBatchedCount, size_t *pTextDrawCount);
+
 void iV_TransBoxFill(float x0, float y0, float x1, float y1);
 void pie_UniTransBoxFill(float x0, float y0, float x1, float y1, PIELIGHT colour);
 
 bool pie_InitRadar();
 bool pie_ShutdownRadar();
 void pie_DownLoadRadar(UDWORD *buffer);
+void pie_DownLoadRadarRows(UDWORD *buffer, size_t firstRow, size_t numRows);
 void pie_RenderRadar(const glm::mat4 &modelViewProjectionMatrix);
 void pie_SetRadar(gfx_api::gfxFloat x, gfx_api::gfxFloat y, gfx_api::gfxFloat width, gfx_api::gfxFloat height, size_t twidth, size_t theight);
 
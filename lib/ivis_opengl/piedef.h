@@ -46,6 +46,8 @@ struct iIMDShape;
 bool pie_Draw3DShape(iIMDShape *shape, int frame, int team, PIELIGHT colour, int pieFlag, int pieFlagData, const glm::mat4 &modelView);
 
 void pie_GetResetCounts(size_t *pPieCount, size_t *pPolyCount);
+/** Number of models drawn by pie_RemainingPasses, and how many of those had to rebind buffers and textures. */
+void pie_GetResetDrawCounts(size_t *pDrawCount, size_t *pStateChangeCount);
 
 /** Setup stencil shadows and OpenGL lighting. */
 void pie_BeginLighting(const Vector3f &light);
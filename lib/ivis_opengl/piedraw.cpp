@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "lib/framework/frame.h"
+#include "lib/framework/radixsort.h"
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/imd.h"
 #include "lib/ivis_opengl/piefunc.h"
@@ -53,6 +54,8 @@
 
 static size_t pieCount = 0;
 static size_t polyCount = 0;
+static size_t drawCount = 0;
+static size_t stateChangeCount = 0;
 static bool shadows = false;
 static gfx_api::gfxFloat lighting0[LIGHT_MAX][4];
 
@@ -125,6 +128,16 @@ struct SHAPE
 static std::vector<ShadowcastingShape> scshapes;
 static std::vector<SHAPE> tshapes;
 static std::vector<SHAPE> shapes;
+
+/// Position of a SHAPE in the draw order.
+struct SHAPE_KEY
+{
+	uint64_t	key;
+	uint32_t	index;	///< Index into shapes or tshapes.
+};
+
+static std::vector<SHAPE_KEY> shapeOrder;
+static std::vector<SHAPE_KEY> shapeOrderScratch;
 static gfx_api::buffer* pZeroedVertexBuffer = nullptr;
 
 static gfx_api::buffer* getZeroedVertexBuffer(size_t size)
@@ -780,53 +793,81 @@ static void pie_DrawShadows(uint64_t currentGameFrame)
 	shadowCache.removeUnused();
 }
 
-struct less_than_shape
+/// The part of the sort key that groups draws sharing a templatedState: the model, then the flags.
+static inline uint64_t shapeStateKey(const SHAPE &shape)
+{
+	return ((uint64_t)(reinterpret_cast<uintptr_t>(shape.shape) >> 4) & 0xFFFFFFFF) << 16 | (uint64_t)(shape.flag & 0xFFFF);
+}
+
+/// Maps view space depth to a key that sorts far to near.
+static inline uint32_t farToNearKey(float depth)
+{
+	uint32_t bits;
+	memcpy(&bits, &depth, sizeof(bits));
+	bits = (bits & 0x80000000) ? ~bits : bits | 0x80000000;  // Now sorts near to far, as unsigned.
+	return ~bits;
+}
+
+/// Sorts the draws of list into shapeOrder. Opaque draws are grouped by texture page and then by state,
+/// since their order does not change the picture. Translucent draws are sorted far to near, and grouped
+/// by state only where the depth is equal.
+static void pie_SortShapes(const std::vector<SHAPE> &list, bool translucent)
 {
-	inline bool operator() (const SHAPE& shape1, const SHAPE& shape2)
+	shapeOrder.resize(list.size());
+	for (size_t i = 0; i < list.size(); ++i)
 	{
-		return (shape1.shape < shape2.shape);
+		const SHAPE &shape = list[i];
+		uint64_t key;
+		if (translucent)
+		{
+			key = (uint64_t)farToNearKey(shape.matrix[3][2]) << 32 | (shapeStateKey(shape) & 0xFFFFFFFF);
+		}
+		else
+		{
+			key = (uint64_t)std::min<size_t>(shape.shape->texpage, 0xFFFF) << 48 | shapeStateKey(shape);
+		}
+		shapeOrder[i] = {key, (uint32_t)i};
 	}
-};
+	radixSortByKey(shapeOrder, shapeOrderScratch);
+}
 
-void pie_RemainingPasses(uint64_t currentGameFrame)
+static void pie_DrawShapes(const std::vector<SHAPE> &list)
 {
-	// Draw models
-	// sort list to reduce state changes
-	std::sort(shapes.begin(), shapes.end(), less_than_shape());
-	gfx_api::context::get().debugStringMarker("Remaining passes - opaque models");
 	templatedState lastState;
-	for (SHAPE const &shape : shapes)
+	for (SHAPE_KEY const &order : shapeOrder)
 	{
+		SHAPE const &shape = list[order.index];
 		pie_SetShaderStretchDepth(shape.stretch);
-		lastState = pie_Draw3DShape2(lastState, shape.shape, shape.frame, shape.colour, shape.teamcolour, shape.flag, shape.flag_data, shape.matrix);
+		templatedState state = pie_Draw3DShape2(lastState, shape.shape, shape.frame, shape.colour, shape.teamcolour, shape.flag, shape.flag_data, shape.matrix);
+		stateChangeCount += state != lastState;
+		++drawCount;
+		lastState = state;
 	}
 	gfx_api::context::get().disable_all_vertex_buffers();
-	if (!shapes.empty())
+	if (!shapeOrder.empty())
 	{
 		// unbind last index buffer bound inside pie_Draw3DShape2
-		gfx_api::context::get().unbind_index_buffer(*((shapes.back().shape)->buffers[VBO_INDEX]));
+		gfx_api::context::get().unbind_index_buffer(*(list[shapeOrder.back().index].shape->buffers[VBO_INDEX]));
 	}
+}
+
+void pie_RemainingPasses(uint64_t currentGameFrame)
+{
+	// Draw models
+	// sort list to reduce state changes
+	pie_SortShapes(shapes, false);
+	gfx_api::context::get().debugStringMarker("Remaining passes - opaque models");
+	pie_DrawShapes(shapes);
 	gfx_api::context::get().debugStringMarker("Remaining passes - shadows");
 	// Draw shadows
 	if (shadows)
 	{
 		pie_DrawShadows(currentGameFrame);
 	}
-	// Draw translucent models last
-	// TODO, sort list by Z order to do translucency correctly
+	// Draw translucent models last, far to near
+	pie_SortShapes(tshapes, true);
 	gfx_api::context::get().debugStringMarker("Remaining passes - translucent models");
-	lastState = templatedState();
-	for (SHAPE const &shape : tshapes)
-	{
-		pie_SetShaderStretchDepth(shape.stretch);
-		lastState = pie_Draw3DShape2(lastState, shape.shape, shape.frame, shape.colour, shape.teamcolour, shape.flag, shape.flag_data, shape.matrix);
-	}
-	gfx_api::context::get().disable_all_vertex_buffers();
-	if (!tshapes.empty())
-	{
-		// unbind last index buffer bound inside pie_Draw3DShape2
-		gfx_api::context::get().unbind_index_buffer(*((tshapes.back().shape)->buffers[VBO_INDEX]));
-	}
+	pie_DrawShapes(tshapes);
 	pie_SetShaderStretchDepth(0);
 	tshapes.clear();
 	shapes.clear();
@@ -841,3 +882,12 @@ void pie_GetResetCounts(size_t *pPieCount, size_t *pPolyCount)
 	pieCount = 0;
 	polyCount = 0;
 }
+
+void pie_GetResetDrawCounts(size_t *pDrawCount, size_t *pStateChangeCount)
+{
+	*pDrawCount = drawCount;
+	*pStateChangeCount = stateChangeCount;
+
+	drawCount = 0;
+	stateChangeCount = 0;
+}
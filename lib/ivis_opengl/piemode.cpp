@@ -33,6 +33,7 @@
 #include "lib/ivis_opengl/piedef.h"
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/piemode.h"
+#include "lib/ivis_opengl/pieblitfunc.h"
 #include "piematrix.h"
 #include "lib/ivis_opengl/piefunc.h"
 #include "lib/ivis_opengl/tex.h"
@@ -91,6 +92,7 @@ void pie_ShutDown()
 
 void pie_ScreenFlip(int clearMode)
 {
+	pie_FlushBatched2D();
 	screenDoDumpToDiskIfRequired();
 	gfx_api::context::get().flip(clearMode);
 	wzPerfFrame();
@@ -25,6 +25,7 @@
 #include <png.h>
 #include <physfs.h>
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/wzapp.h"
 #include <algorithm>
 
 #define PNG_BYTES_TO_CHECK 8
@@ -476,14 +477,17 @@ IMGSaveError iV_saveImage_PNG_Gray(const char *fileName, const iV_Image *image)
 	return internal_saveImage_PNG(fileName, image, PNG_COLOR_TYPE_GRAY);
 }
 
-// Note: This function is *NOT* thread-safe (jpeg_encode_image is not thread-safe).
-void iV_saveImage_JPEG(const char *fileName, const iV_Image *image)
+// jpeg_encode_image keeps its state in globals, so only one image can be encoded at a time.
+static wz::mutex jpegEncoderMutex;
+
+IMGSaveError iV_saveImage_JPEG(const char *fileName, const iV_Image *image)
 {
 	unsigned char *buffer = nullptr;
 	unsigned char *jpeg = nullptr;
 	char newfilename[PATH_MAX];
 	unsigned int currentRow;
 	const unsigned int row_stride = image->width * 3; // 3 bytes per pixel
+	const size_t jpegSize = (size_t)8 * image->width * image->height; // Same margin as always, quality factor 1 compresses very little
 	PHYSFS_file *fileHandle;
 	unsigned char *jpeg_end;
 
@@ -492,15 +496,17 @@ void iV_saveImage_JPEG(const char *fileName, const iV_Image *image)
 	fileHandle = PHYSFS_openWrite(newfilename);
 	if (fileHandle == nullptr)
 	{
-		debug(LOG_ERROR, "pie_JPEGSaveFile: PHYSFS_openWrite failed (while opening file %s) with error: %s\n", fileName, WZ_PHYSFS_getLastError());
-		return;
+		return IMGSaveError(std::string("pie_JPEGSaveFile: PHYSFS_openWrite failed (while opening file ") + newfilename + ") with error: " + WZ_PHYSFS_getLastError());
 	}
 
-	buffer = (unsigned char *)malloc(sizeof(const char *) * image->height * image->width); // Suspect it should be sizeof(unsigned char)*3 == 3 here, not sizeof(const char *) == 8.
-	if (buffer == nullptr)
+	buffer = (unsigned char *)malloc((size_t)row_stride * image->height);
+	jpeg = (unsigned char *)malloc(jpegSize);
+	if (buffer == nullptr || jpeg == nullptr)
 	{
-		debug(LOG_ERROR, "pie_JPEGSaveFile: Couldn't allocate memory\n");
-		return;
+		free(buffer);
+		free(jpeg);
+		PHYSFS_close(fileHandle);
+		return IMGSaveError("pie_JPEGSaveFile: Couldn't allocate memory");
 	}
 
 	// Create an array of scanlines
@@ -511,19 +517,20 @@ void iV_saveImage_JPEG(const char *fileName, const iV_Image *image)
 		memcpy(buffer + row_stride * currentRow, &image->bmp[row_stride * (image->height - currentRow - 1)], row_stride);
 	}
 
-	jpeg = (unsigned char *)malloc(sizeof(const char *) * image->height * image->width); // Suspect it should be something else here, but sizeof(const char *) == 8 is hopefully big enough...
-	if (jpeg == nullptr)
 	{
-		debug(LOG_ERROR, "pie_JPEGSaveFile: Couldn't allocate memory\n");
-		free(buffer);
-		return;
+		std::lock_guard<wz::mutex> lock(jpegEncoderMutex);
+		jpeg_end = jpeg_encode_image(buffer, jpeg, 1, JPEG_FORMAT_RGB, image->width, image->height);
 	}
-
-	jpeg_end = jpeg_encode_image(buffer, jpeg, 1, JPEG_FORMAT_RGB, image->width, image->height);
-	WZ_PHYSFS_writeBytes(fileHandle, jpeg, jpeg_end - jpeg);
+	ASSERT(jpeg_end >= jpeg && (size_t)(jpeg_end - jpeg) <= jpegSize, "JPEG output overflowed its buffer");
+	PHYSFS_sint64 written = WZ_PHYSFS_writeBytes(fileHandle, jpeg, jpeg_end - jpeg);
 
 	free(buffer);
 	free(jpeg);
 	PHYSFS_close(fileHandle);
+	if (written != jpeg_end - jpeg)
+	{
+		return IMGSaveError(std::string("pie_JPEGSaveFile: Could not write ") + newfilename + ": " + WZ_PHYSFS_getLastError());
+	}
+	return IMGSaveError::None;
 }
 
@@ -82,6 +82,15 @@ IMGSaveError iV_saveImage_PNG(const char *fileName, const iV_Image *image);
  */
 IMGSaveError iV_saveImage_PNG_Gray(const char *fileName, const iV_Image *image);
 
-void iV_saveImage_JPEG(const char *fileName, const iV_Image *image);
+/*!
+ * Save a JPEG from image into file, replacing the extension of fileName with ".jpg".
+ *
+ * This function is safe to call from any thread
+ *
+ * \param fileName output file to save to
+ * \param image Texture to read from
+ * \return an IMGSaveError struct. On failure, its "text" contains a description of the error.
+ */
+IMGSaveError iV_saveImage_JPEG(const char *fileName, const iV_Image *image);
 
 #endif // _LIBIVIS_COMMON_PNG_H_
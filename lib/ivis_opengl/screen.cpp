@@ -29,6 +29,7 @@
 #include "lib/framework/wztime.h"
 #include "lib/exceptionhandler/dumpinfo.h"
 #include "lib/ivis_opengl/png_util.h"
+#include "lib/ivis_opengl/imagewriter.h"
 #include "lib/ivis_opengl/tex.h"
 #include "lib/ivis_opengl/textdraw.h"
 #include "lib/ivis_opengl/piestate.h"
@@ -229,6 +230,9 @@ void screenShutDown()
 	delete backdropGfx;
 	backdropGfx = nullptr;
 
+	pie_ShutdownBatched2D();
+	iV_imageWriterShutdown();
+
 	delete pie_internal::rectBuffer;
 	pie_internal::rectBuffer = nullptr;
 
@@ -429,63 +433,6 @@ void screen_disableMapPreview()
 
 // Screenshot code goes below this
 
-class ScreenshotSaveRequest {
-public:
-	typedef std::function<void (const ScreenshotSaveRequest&)> onDeleteFunc;
-
-	WzString fileName;
-	std::unique_ptr<iV_Image> image;
-	onDeleteFunc onDelete;
-
-	ScreenshotSaveRequest(const WzString & fileName, std::unique_ptr<iV_Image>&& image, const onDeleteFunc & onDelete)
-	: fileName(fileName)
-	, image(std::move(image))
-	, onDelete(onDelete)
-	{ }
-
-	~ScreenshotSaveRequest()
-	{
-		onDelete(*this);
-	}
-};
-
-/** This runs in a separate thread */
-static int saveScreenshotThreadFunc(void * saveRequest)
-{
-	assert(saveRequest != nullptr);
-	ScreenshotSaveRequest * pSaveRequest = static_cast<ScreenshotSaveRequest *>(saveRequest);
-
-	IMGSaveError pngerror = iV_saveImage_PNG(pSaveRequest->fileName.toUtf8().c_str(), pSaveRequest->image.get());
-
-//	//iV_saveImage_JPEG is *NOT* thread-safe, and cannot be safely called from another thread
-//	iV_saveImage_JPEG(fileName, &image);
-
-	if (!pngerror.noError())
-	{
-		// dispatch logging the error to the main thread
-		wzAsyncExecOnMainThread([pngerror]
-			{
-				debug(LOG_ERROR, "%s\n", pngerror.text.c_str());
-			}
-		);
-	}
-	else
-	{
-		// display message to user about screenshot
-		// this must be dispatched back to the main thread
-		WzString fileName = pSaveRequest->fileName;
-		wzAsyncExecOnMainThread([fileName]
-		   {
-			   snprintf(ConsoleString, sizeof(ConsoleString), "Screenshot %s saved!", fileName.toUtf8().c_str());
-			   addConsoleMessage(ConsoleString, LEFT_JUSTIFY, SYSTEM_MESSAGE);
-		   }
-		);
-	}
-
-	delete pSaveRequest;
-	return 0;
-}
-
 /** Writes a screenshot of the current frame to file.
  *
  *  Performs the actual work of writing the frame currently displayed on screen
@@ -516,32 +463,20 @@ void screenDoDumpToDiskIfRequired()
 			return;
 		}
 
-		// Dispatch encoding and saving screenshot to a background thread (since this is fairly costly)
+		// Dispatch encoding and saving screenshot to the image writer thread (since this is fairly costly)
 		snprintf(ConsoleString, sizeof(ConsoleString), "Saving screenshot %s ...", fileName.toUtf8().c_str());
 		addConsoleMessage(ConsoleString, LEFT_JUSTIFY, INFO_MESSAGE);
-		ScreenshotSaveRequest * pSaveRequest =
-			new ScreenshotSaveRequest(
-				fileName,
-				std::move(image),
-				[](const ScreenshotSaveRequest& request)
-				{
-					if (request.image->bmp)
-					{
-						free(request.image->bmp);
-					}
-				}
-			);
-		WZ_THREAD * pSaveThread = wzThreadCreate(saveScreenshotThreadFunc, pSaveRequest);
-		if (pSaveThread == nullptr)
-		{
-			debug(LOG_ERROR, "Failed to create thread for PNG encoding");
-			delete pSaveRequest;
-		}
-		else
+		iV_queueSaveImage(fileName.toStdString(), std::move(image), IMGFileFormat::PNG, 0, [](const std::string &savedFileName, const IMGSaveError &error)
 		{
-			wzThreadDetach(pSaveThread);
-			// the thread handles deleting pSaveRequest
-		}
+			if (!error.noError())
+			{
+				debug(LOG_ERROR, "%s", error.text.c_str());
+				return;
+			}
+			// display message to user about screenshot
+			snprintf(ConsoleString, sizeof(ConsoleString), "Screenshot %s saved!", savedFileName.c_str());
+			addConsoleMessage(ConsoleString, LEFT_JUSTIFY, SYSTEM_MESSAGE);
+		});
 	});
 
 	if (!bSentRequest)
@@ -1490,6 +1490,12 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 
 	if (NetPlay.isHost)
 	{
+		// Serialise the message only once, all the sockets share the same buffer, and compress it on the socket thread.
+		std::shared_ptr<std::vector<uint8_t>> rawDataBuffer = std::make_shared<std::vector<uint8_t>>();
+		message->rawDataAppendToVector(*rawDataBuffer);
+		SocketSharedBuffer const rawData = std::move(rawDataBuffer);
+		ssize_t rawLen = rawData->size();
+
 		int firstPlayer = player == NET_ALL_PLAYERS ? 0                         : player;
 		int lastPlayer  = player == NET_ALL_PLAYERS ? MAX_CONNECTED_PLAYERS - 1 : player;
 		for (player = firstPlayer; player <= lastPlayer; ++player)
@@ -1497,11 +1503,8 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 			// We are the host, send directly to player.
 			if (sockets[player] != nullptr && player != queue.exclude)
 			{
-				uint8_t *rawData = message->rawDataDup();
-				ssize_t rawLen   = message->rawLen();
 				size_t compressedRawLen;
-				result = writeAll(sockets[player], rawData, rawLen, &compressedRawLen);
-				delete[] rawData;  // Done with the data.
+				result = writeAll(sockets[player], rawData, &compressedRawLen);
 
 				if (result == rawLen)
 				{
@@ -1528,11 +1531,11 @@ bool NETsend(NETQUEUE queue, NetMessage const *message)
 		// We are a client, send directly to player, who happens to be the host.
 		if (bsocket)
 		{
-			uint8_t *rawData = message->rawDataDup();
-			ssize_t rawLen   = message->rawLen();
+			std::shared_ptr<std::vector<uint8_t>> rawData = std::make_shared<std::vector<uint8_t>>();
+			message->rawDataAppendToVector(*rawData);
+			ssize_t rawLen   = rawData->size();
 			size_t compressedRawLen;
-			result = writeAll(bsocket, rawData, rawLen, &compressedRawLen);
-			delete[] rawData;  // Done with the data.
+			result = writeAll(bsocket, SocketSharedBuffer(std::move(rawData)), &compressedRawLen);
 
 			if (result == rawLen)
 			{
@@ -100,11 +100,13 @@ bool decode_uint32_t(uint8_t b, uint32_t &v, unsigned n)
 	return !isLastByte;
 }
 
-uint8_t *NetMessage::rawDataDup() const
+void NetMessage::rawDataAppendToVector(std::vector<uint8_t> &output) const
 {
 	unsigned encodedLengthOfSize = encodedlength_uint32_t(data.size());
 
-	uint8_t *ret = new uint8_t[1 + encodedLengthOfSize + data.size()];
+	size_t start = output.size();
+	output.resize(start + 1 + encodedLengthOfSize + data.size());
+	uint8_t *ret = &output[start];
 
 	ret[0] = type;
 
@@ -115,7 +117,6 @@ uint8_t *NetMessage::rawDataDup() const
 	}
 
 	std::copy(data.begin(), data.end(), ret + 1 + encodedLengthOfSize);
-	return ret;
 }
 
 size_t NetMessage::rawLen() const
@@ -123,47 +124,79 @@ size_t NetMessage::rawLen() const
 	return 1 + static_cast<size_t>(encodedlength_uint32_t(data.size())) + data.size();
 }
 
+// Maximum number of data buffers of popped messages kept for reuse, per queue, and the maximum size of a kept buffer.
+static const size_t maxSpareMessageData = 256;
+static const size_t maxSpareMessageDataCapacity = 65536;
+
 NetQueue::NetQueue()
 	: canGetMessagesForNet(true)
 	, canGetMessages(true)
+	, dataPos(0)
+	, messagePos(0)
 {
-	dataPos = messages.end();
-	messagePos = messages.end();
 }
 
-void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
+NetMessage &NetQueue::newMessage(uint8_t type)
 {
-	size_t used = 0;
-	std::vector<uint8_t> &buffer = incompleteReceivedMessageData;  // Short alias.
+	messages.push_back(NetMessage(type));
+	NetMessage &message = messages.back();
+	if (!spareData.empty())
+	{
+		message.data.swap(spareData.back());
+		spareData.pop_back();
+	}
+	return message;
+}
 
-	// Insert the data.
-	buffer.insert(buffer.end(), netData, netData + netLen);
+size_t NetQueue::extractMessages(const uint8_t *netData, size_t netLen)
+{
+	size_t used = 0;
 
-	// Extract the messages.
-	while (buffer.size() - used > 1)
+	while (netLen - used > 1)
 	{
-		uint8_t type = buffer[used];
+		uint8_t type = netData[used];
 
 		uint32_t len = 0;
 		bool moreBytes = true;
 		unsigned n;
-		for (n = 0; moreBytes && buffer.size() - used > 1 + n; ++n)
+		for (n = 0; moreBytes && netLen - used > 1 + n; ++n)
 		{
-			moreBytes = decode_uint32_t(buffer[used + 1 + n], len, n);
+			moreBytes = decode_uint32_t(netData[used + 1 + n], len, n);
 		}
 		unsigned headerLen = 1 + n;
 
 		ASSERT(len < 40000000, "Trying to write a very large packet (%u bytes) to the queue.", len);
-		if (buffer.size() - used - headerLen < len)
+		if (moreBytes || netLen - used - headerLen < len)
 		{
 			break;  // Don't have a whole message ready yet.
 		}
 
-		messages.push_front(NetMessage(type));
-		messages.front().data.assign(buffer.begin() + used + headerLen, buffer.begin() + used + headerLen + len);
+		// Copy the message data straight from the network buffer, into a reused data buffer.
+		newMessage(type).data.assign(netData + used + headerLen, netData + used + headerLen + len);
 		used += headerLen + len;
 	}
 
+	return used;
+}
+
+void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
+{
+	std::vector<uint8_t> &buffer = incompleteReceivedMessageData;  // Short alias.
+
+	if (buffer.empty())
+	{
+		// Usual case, extract the messages in place, and only keep any incomplete message at the end.
+		size_t used = extractMessages(netData, netLen);
+		buffer.assign(netData + used, netData + netLen);
+		return;
+	}
+
+	// Insert the data after the incomplete message.
+	buffer.insert(buffer.end(), netData, netData + netLen);
+
+	// Extract the messages.
+	size_t used = extractMessages(buffer.data(), buffer.size());
+
 	// Recycle old data.
 	buffer.erase(buffer.begin(), buffer.begin() + used);
 }
@@ -175,36 +208,30 @@ void NetQueue::setWillNeverGetMessagesForNet()
 
 unsigned NetQueue::numMessagesForNet() const
 {
-	unsigned count = 0;
-	if (canGetMessagesForNet)
+	if (!canGetMessagesForNet)
 	{
-		for (List::iterator i = dataPos; i != messages.begin(); --i)
-		{
-			++count;
-		}
+		return 0;
 	}
 
-	return count;
+	return messages.size() - dataPos;
 }
 
 const NetMessage &NetQueue::getMessageForNet() const
 {
 	ASSERT(canGetMessagesForNet, "Wrong NetQueue type for getMessageForNet.");
-	ASSERT(dataPos != messages.begin(), "No message to get!");
+	ASSERT(dataPos != messages.size(), "No message to get!");
 
 	// Return the message.
-	List::iterator i = dataPos;
-	--i;
-	return *i;
+	return messages[dataPos];
 }
 
 void NetQueue::popMessageForNet()
 {
 	ASSERT(canGetMessagesForNet, "Wrong NetQueue type for popMessageForNet.");
-	ASSERT(dataPos != messages.begin(), "No message to pop!");
+	ASSERT(dataPos != messages.size(), "No message to pop!");
 
 	// Pop the message.
-	--dataPos;
+	++dataPos;
 
 	// Recycle old data.
 	popOldMessages();
@@ -212,7 +239,7 @@ void NetQueue::popMessageForNet()
 
 void NetQueue::pushMessage(const NetMessage &message)
 {
-	messages.push_front(message);
+	newMessage(message.type).data.assign(message.data.begin(), message.data.end());
 }
 
 void NetQueue::setWillNeverGetMessages()
@@ -223,27 +250,25 @@ void NetQueue::setWillNeverGetMessages()
 bool NetQueue::haveMessage() const
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for haveMessage.");
-	return messagePos != messages.begin();
+	return messagePos != messages.size();
 }
 
 const NetMessage &NetQueue::getMessage() const
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for getMessage.");
-	ASSERT(messagePos != messages.begin(), "No message to get!");
+	ASSERT(messagePos != messages.size(), "No message to get!");
 
 	// Return the message.
-	List::iterator i = messagePos;
-	--i;
-	return *i;
+	return messages[messagePos];
 }
 
 void NetQueue::popMessage()
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for popMessage.");
-	ASSERT(messagePos != messages.begin(), "No message to pop!");
+	ASSERT(messagePos != messages.size(), "No message to pop!");
 
 	// Pop the message.
-	--messagePos;
+	++messagePos;
 
 	// Recycle old data.
 	popOldMessages();
@@ -253,27 +278,25 @@ void NetQueue::popOldMessages()
 {
 	if (!canGetMessagesForNet)
 	{
-		dataPos = messages.begin();
+		dataPos = messages.size();
 	}
 	if (!canGetMessages)
 	{
-		messagePos = messages.begin();
+		messagePos = messages.size();
 	}
 
-	List::iterator i = messages.end();
-	while (i != dataPos && i != messagePos)
+	// Messages before both dataPos and messagePos are no longer needed.
+	size_t numOld = std::min(dataPos, messagePos);
+	for (size_t n = 0; n < numOld; ++n)
 	{
-		--i;
-	}
-
-	if (i == dataPos)
-	{
-		dataPos = messages.end();  // Old iterator will become invalid.
-	}
-	if (i == messagePos)
-	{
-		messagePos = messages.end();  // Old iterator will become invalid.
+		if (spareData.size() < maxSpareMessageData && messages.front().data.capacity() <= maxSpareMessageDataCapacity)
+		{
+			spareData.push_back(std::vector<uint8_t>());
+			spareData.back().swap(messages.front().data);
+			spareData.back().clear();
+		}
+		messages.pop_front();
 	}
-
-	messages.erase(i, messages.end());
+	dataPos -= numOld;
+	messagePos -= numOld;
 }
@@ -26,8 +26,8 @@
 
 #include "lib/framework/frame.h"
 #include <vector>
-#include <list>
 #include <deque>
+#include <algorithm>
 
 // At game level:
 // There should be a NetQueue representing each client.
@@ -45,8 +45,8 @@ class NetMessage
 {
 public:
 	NetMessage(uint8_t type_ = 0xFF) : type(type_) {}
-	uint8_t *rawDataDup() const;  ///< Returns data compatible with NetQueue::writeRawData(). Must be delete[]d.
-	size_t rawLen() const;        ///< Returns the length of the return value of rawDataDup().
+	void rawDataAppendToVector(std::vector<uint8_t> &output) const;  ///< Appends data compatible with NetQueue::writeRawData() to output.
+	size_t rawLen() const;        ///< Returns the length of the data appended by rawDataAppendToVector().
 	uint8_t type;
 	std::vector<uint8_t> data;
 };
@@ -63,6 +63,10 @@ public:
 	{
 		message->data.push_back(v);
 	}
+	void bytes(uint8_t *v, size_t n) const
+	{
+		message->data.insert(message->data.end(), v, v + n);
+	}
 	bool valid() const
 	{
 		return true;
@@ -82,6 +86,14 @@ public:
 		v = index >= message->data.size() ? 0x00 : message->data[index];
 		++index;
 	}
+	void bytes(uint8_t *v, size_t n) const
+	{
+		size_t start = std::min(index, message->data.size());  // index may be past the end of truncated messages
+		size_t available = std::min(n, message->data.size() - start);
+		std::copy(message->data.begin() + start, message->data.begin() + start + available, v);
+		std::fill(v + available, v + n, 0x00);
+		index += n;
+	}
 	bool valid() const
 	{
 		return index <= message->data.size();
@@ -91,6 +103,7 @@ public:
 };
 
 /// A NetQueue is a queue of NetMessages. A NetQueue can convert the messages into a stream of bytes, which can be sent over the network, and converted back into a queue of NetMessages by the NetQueue at the other end.
+/// References returned by getMessage() and getMessageForNet() stay valid until the message is popped, even if more messages are pushed meanwhile.
 class NetQueue
 {
 public:
@@ -114,6 +127,8 @@ public:
 	void popMessage();                                                 ///< Pops the last returned message.
 
 private:
+	NetMessage &newMessage(uint8_t type);                              ///< Appends an empty message, reusing the data buffer of an old message if possible.
+	size_t extractMessages(const uint8_t *netData, size_t netLen);     ///< Appends the complete messages in netData, returns the number of bytes used.
 	void popOldMessages();                                             ///< Pops any messages that are no longer needed.
 
 	// Disable copy constructor and assignment operator.
@@ -123,10 +138,10 @@ private:
 	bool canGetMessagesForNet;                                         ///< True if we will send the messages over the network, false if we don't.
 	bool canGetMessages;                                               ///< True if we will get the messages, false if we don't use them ourselves.
 
-	typedef std::list<NetMessage> List;
-	List::iterator                dataPos;                             ///< Last message which was sent over the network.
-	List::iterator                messagePos;                          ///< Last message which was popped.
-	List                          messages;                            ///< List of messages. Messages are added to the front and read from the back.
+	size_t                        dataPos;                             ///< Index of the first message which has not been sent over the network.
+	size_t                        messagePos;                          ///< Index of the first message which has not been popped.
+	std::deque<NetMessage>        messages;                            ///< Messages, oldest first. Messages are added to the back and read from the front.
+	std::vector<std::vector<uint8_t>> spareData;                       ///< Data buffers of popped messages, kept for reuse, so that queueing messages doesn't normally allocate.
 	std::vector<uint8_t>          incompleteReceivedMessageData;       ///< Data from network which has not yet formed an entire message.
 };
 
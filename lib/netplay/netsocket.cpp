@@ -30,12 +30,23 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <deque>
 
 #if !defined(ZLIB_CONST)
 #  define ZLIB_CONST
 #endif
 #include <zlib.h>
 
+// The socket thread waits for writable sockets with epoll on Linux, with poll(2) on other Unix systems, and with select() on Windows.
+#if defined(WZ_OS_UNIX)
+#  include <poll.h>
+#  define WZ_SOCKET_USE_POLL
+#endif
+#if defined(WZ_OS_LINUX)
+#  include <sys/epoll.h>
+#  define WZ_SOCKET_USE_EPOLL
+#endif
+
 enum
 {
 	SOCK_CONNECTION,
@@ -52,7 +63,7 @@ struct Socket
 	 *
 	 * All non-listening sockets will only use the first socket handle.
 	 */
-	Socket() : ready(false), writeError(false), deleteLater(false), isCompressed(false), readDisconnected(false), zDeflateInSize(0)
+	Socket() : ready(false), writeError(false), deleteLater(false), isCompressed(false), readDisconnected(false), zDeflateFlushQueued(false), zDeflateBusy(false), zDeflateOutSize(0)
 	{
 		memset(&zDeflate, 0, sizeof(zDeflate));
 		memset(&zInflate, 0, sizeof(zInflate));
@@ -67,12 +78,17 @@ struct Socket
 
 	bool isCompressed;
 	bool readDisconnected;  ///< True iff a call to recv() returned 0.
-	z_stream zDeflate;
+	z_stream zDeflate;              ///< Only used by the socket thread, once compression has begun.
 	z_stream zInflate;
-	unsigned zDeflateInSize;
 	bool zInflateNeedInput;
-	std::vector<uint8_t> zDeflateOutBuf;
+	std::vector<uint8_t> zDeflateOutBuf;  ///< Only used by the socket thread.
 	std::vector<uint8_t> zInflateInBuf;
+
+	// Protected by socketThreadMutex.
+	std::vector<SocketSharedBuffer> zDeflatePendingInput;  ///< Data written since the last socketFlush(), to be compressed by the socket thread.
+	bool zDeflateFlushQueued;       ///< True while this socket is in socketThreadDeflateQueue.
+	bool zDeflateBusy;              ///< True while the socket thread is compressing data for this socket, with socketThreadMutex unlocked.
+	size_t zDeflateOutSize;         ///< Number of compressed bytes produced, but not yet reported by socketFlush().
 };
 
 struct SocketSet
@@ -80,13 +96,94 @@ struct SocketSet
 	std::vector<Socket *> fds;
 };
 
+/**
+ * Queue of bytes waiting to be sent on a socket, stored as a chain of fixed size chunks.
+ *
+ * Appending copies into the last chunk, and consuming the bytes written by a partial send() only advances
+ * an offset into the first chunk, so neither is proportional to the amount of data still queued.
+ * Fully consumed chunks are kept for reuse, so a socket with steady traffic doesn't allocate.
+ */
+class SocketWriteQueue
+{
+public:
+	bool empty() const
+	{
+		return chunks.empty();
+	}
+
+	void append(uint8_t const *data, size_t size)
+	{
+		while (size > 0)
+		{
+			if (chunks.empty() || chunks.back().size() == chunks.back().capacity())
+			{
+				chunks.emplace_back();
+				if (!spareChunks.empty())
+				{
+					chunks.back().swap(spareChunks.back());
+					spareChunks.pop_back();
+				}
+				chunks.back().reserve(chunkSize);
+			}
+			std::vector<uint8_t> &chunk = chunks.back();
+			size_t toCopy = std::min(size, chunk.capacity() - chunk.size());
+			chunk.insert(chunk.end(), data, data + toCopy);
+			data += toCopy;
+			size -= toCopy;
+		}
+	}
+
+	/// Returns the first contiguous block of unsent data. Must not be called on an empty queue.
+	uint8_t const *frontData() const
+	{
+		return chunks.front().data() + frontOffset;
+	}
+
+	size_t frontSize() const
+	{
+		return chunks.front().size() - frontOffset;
+	}
+
+	/// Marks size bytes at the front of the queue as sent. size must not exceed frontSize().
+	void consume(size_t size)
+	{
+		frontOffset += size;
+		if (frontOffset == chunks.front().size())
+		{
+			frontOffset = 0;
+			if (spareChunks.size() < maxSpareChunks)
+			{
+				spareChunks.emplace_back();
+				spareChunks.back().swap(chunks.front());
+				spareChunks.back().clear();
+			}
+			chunks.pop_front();
+		}
+	}
+
+private:
+	static const size_t chunkSize = 16384;
+	static const size_t maxSpareChunks = 2;
+
+	std::deque<std::vector<uint8_t>> chunks;
+	std::vector<std::vector<uint8_t>> spareChunks;
+	size_t frontOffset = 0;
+};
+
 
 static WZ_MUTEX *socketThreadMutex;
 static WZ_SEMAPHORE *socketThreadSemaphore;
 static WZ_THREAD *socketThread = nullptr;
 static bool socketThreadQuit;
-typedef std::map<Socket *, std::vector<uint8_t>> SocketThreadWriteMap;
+typedef std::map<Socket *, SocketWriteQueue> SocketThreadWriteMap;
 static SocketThreadWriteMap socketThreadWrites;
+static std::deque<Socket *> socketThreadDeflateQueue;  ///< Sockets which have been flushed, and have data waiting to be compressed.
+#if defined(WZ_SOCKET_USE_POLL)
+static int socketThreadWakeupPipe[2] = {-1, -1};  ///< Written to, to interrupt the socket thread's poll/epoll_wait.
+#endif
+#if defined(WZ_SOCKET_USE_EPOLL)
+static int socketThreadEpollFd = -1;              ///< Sockets with queued data are registered here for EPOLLOUT. If -1, poll(2) is used instead.
+#endif
 
 
 static void socketCloseNow(Socket *sock);
@@ -388,111 +485,383 @@ static bool connectionIsOpen(Socket *sock)
 	return true;
 }
 
-static int socketThreadFunction(void *)
+#if defined(WZ_SOCKET_USE_POLL)
+static void socketThreadWritePipe()
 {
-	wzMutexLock(socketThreadMutex);
-	while (!socketThreadQuit)
+	if (socketThreadWakeupPipe[1] == -1)
 	{
-#if   defined(WZ_OS_UNIX)
-		SOCKET maxfd = INT_MIN;
-#elif defined(WZ_OS_WIN)
-		SOCKET maxfd = 0;
+		return;
+	}
+
+	const char byte = 0;
+	ssize_t ret;
+	do
+	{
+		ret = write(socketThreadWakeupPipe[1], &byte, 1);
+	}
+	while (ret == -1 && errno == EINTR);
+	// If the write failed with EAGAIN, the pipe is full, so the socket thread will wake up anyway.
+}
+
+static void socketThreadDrainWakeupPipe()
+{
+	char buf[64];
+	ssize_t ret;
+	do
+	{
+		ret = read(socketThreadWakeupPipe[0], buf, sizeof(buf));
+	}
+	while (ret > 0 || (ret == -1 && errno == EINTR));
+}
+
+static bool createWakeupPipe(int fds[2])
+{
+	if (pipe(fds) == -1)
+	{
+		debug(LOG_ERROR, "Failed to create socket thread wakeup pipe: %s", strSockError(getSockErr()));
+		fds[0] = fds[1] = -1;
+		return false;
+	}
+	for (int i = 0; i < 2; ++i)
+	{
+		fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(fds[i], F_SETFD, fcntl(fds[i], F_GETFD) | FD_CLOEXEC);
+	}
+	return true;
+}
 #endif
-		fd_set fds;
-		FD_ZERO(&fds);
-		for (SocketThreadWriteMap::iterator i = socketThreadWrites.begin(); i != socketThreadWrites.end(); ++i)
+
+/**
+ * Makes sure the socket thread notices new data to write or compress. Must be called with socketThreadMutex locked.
+ */
+static void socketThreadWakeup()
+{
+#if defined(WZ_SOCKET_USE_POLL)
+	socketThreadWritePipe();
+#else
+	if (socketThreadWrites.empty())
+	{
+		wzSemaphorePost(socketThreadSemaphore);  // The socket thread might be waiting for something to do.
+	}
+#endif
+}
+
+/**
+ * Returns the write queue of the given socket, and makes sure the socket thread will wait for the socket to become
+ * writable, if it wasn't already doing so. Must be called with socketThreadMutex locked.
+ * Returns nullptr, and sets writeError, if the socket can't be waited for. The socket then gets no write queue, so that
+ * socketClose() and socketThreadDeflate() close it right away, instead of waiting for a queue that never drains.
+ */
+static SocketWriteQueue *socketThreadWriteQueue(Socket *sock)
+{
+	SocketThreadWriteMap::iterator i = socketThreadWrites.find(sock);
+	if (i != socketThreadWrites.end())
+	{
+		return &i->second;
+	}
+
+#if defined(WZ_SOCKET_USE_EPOLL)
+	if (socketThreadEpollFd != -1)
+	{
+		struct epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLOUT;
+		event.data.ptr = sock;
+		if (epoll_ctl(socketThreadEpollFd, EPOLL_CTL_ADD, sock->fd[SOCK_CONNECTION], &event) == -1)
 		{
-			if (!i->second.empty())
+			debug(LOG_ERROR, "Failed to add socket %p to epoll set: %s", static_cast<void *>(sock), strSockError(getSockErr()));
+			sock->writeError = true;
+			return nullptr;
+		}
+		return &socketThreadWrites[sock];
+	}
+#endif
+
+	socketThreadWakeup();
+	return &socketThreadWrites[sock];
+}
+
+/**
+ * Stops waiting for the socket to become writable, discarding any unsent data, and closes the socket if
+ * socketClose() was called on it in the meantime. Must be called with socketThreadMutex locked.
+ */
+static void socketThreadRemoveWriteQueue(SocketThreadWriteMap::iterator w)
+{
+	Socket *sock = w->first;
+#if defined(WZ_SOCKET_USE_EPOLL)
+	if (socketThreadEpollFd != -1)
+	{
+		struct epoll_event event;  // Ignored, but must be non-NULL on Linux < 2.6.9.
+		memset(&event, 0, sizeof(event));
+		epoll_ctl(socketThreadEpollFd, EPOLL_CTL_DEL, sock->fd[SOCK_CONNECTION], &event);
+	}
+#endif
+	socketThreadWrites.erase(w);
+	if (sock->deleteLater && !sock->zDeflateFlushQueued && !sock->zDeflateBusy)
+	{
+		socketCloseNow(sock);  // Otherwise socketThreadDeflate() closes it, once the last data is compressed.
+	}
+}
+
+/**
+ * Waits until some sockets with queued data can be written to, and adds them to writable. Must be called with
+ * socketThreadMutex locked, which is unlocked while waiting.
+ */
+static void socketThreadWaitWritable(std::vector<Socket *> &writable)
+{
+#if defined(WZ_SOCKET_USE_EPOLL)
+	if (socketThreadEpollFd != -1)
+	{
+		struct epoll_event events[64];
+		wzMutexUnlock(socketThreadMutex);
+		int ret = epoll_wait(socketThreadEpollFd, events, ARRAY_SIZE(events), -1);
+		wzMutexLock(socketThreadMutex);
+
+		for (int i = 0; i < ret; ++i)
+		{
+			if (events[i].data.ptr == nullptr)
 			{
-				SOCKET fd = i->first->fd[SOCK_CONNECTION];
-				maxfd = std::max(maxfd, fd);
-				ASSERT(!FD_ISSET(fd, &fds), "Duplicate file descriptor!");  // Shouldn't be possible, but blocking in send, after select says it won't block, shouldn't be possible either.
-				FD_SET(fd, &fds);
+				socketThreadDrainWakeupPipe();
+				continue;
 			}
+			writable.push_back(static_cast<Socket *>(events[i].data.ptr));
 		}
-		struct timeval tv = {0, 50 * 1000};
+		return;
+	}
+#endif
 
-		// Check if we can write to any sockets.
+#if defined(WZ_SOCKET_USE_POLL)
+	static std::vector<struct pollfd> fds;
+	static std::vector<Socket *> fdSockets;
+	fds.clear();
+	fdSockets.clear();
+
+	struct pollfd wakeup = {socketThreadWakeupPipe[0], POLLIN, 0};
+	fds.push_back(wakeup);
+	for (SocketThreadWriteMap::iterator i = socketThreadWrites.begin(); i != socketThreadWrites.end(); ++i)
+	{
+		struct pollfd pfd = {i->first->fd[SOCK_CONNECTION], POLLOUT, 0};
+		fds.push_back(pfd);
+		fdSockets.push_back(i->first);
+	}
+
+	wzMutexUnlock(socketThreadMutex);
+	int ret = poll(fds.data(), fds.size(), socketThreadWakeupPipe[0] != -1 ? -1 : 50);  // Without a wakeup pipe, check for new data periodically.
+	wzMutexLock(socketThreadMutex);
+
+	if (ret > 0)
+	{
+		if (fds[0].revents != 0)
+		{
+			socketThreadDrainWakeupPipe();
+		}
+		for (size_t i = 0; i < fdSockets.size(); ++i)
+		{
+			if ((fds[i + 1].revents & (POLLOUT | POLLERR | POLLHUP)) != 0)
+			{
+				writable.push_back(fdSockets[i]);
+			}
+		}
+	}
+#else
+	if (socketThreadWrites.empty() && socketThreadDeflateQueue.empty())
+	{
+		// Nothing to do, expect to wait.
 		wzMutexUnlock(socketThreadMutex);
-		int ret = select(maxfd + 1, nullptr, &fds, nullptr, &tv);
+		wzSemaphoreWait(socketThreadSemaphore);
 		wzMutexLock(socketThreadMutex);
+		return;
+	}
 
-		// We can write to some sockets. (Ignore errors from select, we may have deleted the socket after unlocking the mutex, and before calling select.)
-		if (ret > 0)
+	SOCKET maxfd = 0;
+	fd_set fds;
+	FD_ZERO(&fds);
+	for (SocketThreadWriteMap::iterator i = socketThreadWrites.begin(); i != socketThreadWrites.end(); ++i)
+	{
+		SOCKET fd = i->first->fd[SOCK_CONNECTION];
+		maxfd = std::max(maxfd, fd);
+		ASSERT(!FD_ISSET(fd, &fds), "Duplicate file descriptor!");  // Shouldn't be possible, but blocking in send, after select says it won't block, shouldn't be possible either.
+		FD_SET(fd, &fds);
+	}
+	struct timeval tv = {0, 50 * 1000};
+
+	// Check if we can write to any sockets.
+	wzMutexUnlock(socketThreadMutex);
+	int ret = select(maxfd + 1, nullptr, &fds, nullptr, &tv);
+	wzMutexLock(socketThreadMutex);
+
+	// We can write to some sockets. (Ignore errors from select, we may have deleted the socket after unlocking the mutex, and before calling select.)
+	if (ret > 0)
+	{
+		for (SocketThreadWriteMap::iterator i = socketThreadWrites.begin(); i != socketThreadWrites.end(); ++i)
 		{
-			for (SocketThreadWriteMap::iterator i = socketThreadWrites.begin(); i != socketThreadWrites.end();)
+			if (FD_ISSET(i->first->fd[SOCK_CONNECTION], &fds))
 			{
-				SocketThreadWriteMap::iterator w = i;
-				++i;
+				writable.push_back(i->first);
+			}
+		}
+	}
+#endif
+}
 
-				Socket *sock = w->first;
-				std::vector<uint8_t> &writeQueue = w->second;
-				ASSERT(!writeQueue.empty(), "writeQueue[sock] must not be empty.");
+/**
+ * Writes as much of the queued data as the socket accepts without blocking. Must be called with socketThreadMutex locked.
+ */
+static void socketThreadSend(SocketThreadWriteMap::iterator w)
+{
+	Socket *sock = w->first;
+	SocketWriteQueue &writeQueue = w->second;
 
-				if (!FD_ISSET(sock->fd[SOCK_CONNECTION], &fds))
-				{
-					continue;  // This socket is not ready for writing, or we don't have anything to write.
-				}
+	while (!writeQueue.empty())
+	{
+		// FIXME SOMEHOW AAARGH This send() call can't block, but unless the socket is not set to blocking (setting the socket to nonblocking had better work, or else), does anyway (at least sometimes, when someone quits). Not reproducible except in public releases.
+		ssize_t retSent = send(sock->fd[SOCK_CONNECTION], reinterpret_cast<char const *>(writeQueue.frontData()), writeQueue.frontSize(), MSG_NOSIGNAL);
+		if (retSent != SOCKET_ERROR)
+		{
+			writeQueue.consume(retSent);
+			continue;
+		}
 
-				// Write data.
-				// FIXME SOMEHOW AAARGH This send() call can't block, but unless the socket is not set to blocking (setting the socket to nonblocking had better work, or else), does anyway (at least sometimes, when someone quits). Not reproducible except in public releases.
-				ssize_t retSent = send(sock->fd[SOCK_CONNECTION], reinterpret_cast<char *>(&writeQueue[0]), writeQueue.size(), MSG_NOSIGNAL);
-				if (retSent != SOCKET_ERROR)
-				{
-					// Erase as much data as written.
-					writeQueue.erase(writeQueue.begin(), writeQueue.begin() + retSent);
-					if (writeQueue.empty())
-					{
-						socketThreadWrites.erase(w);  // Nothing left to write, delete from pending list.
-						if (sock->deleteLater)
-						{
-							socketCloseNow(sock);
-						}
-					}
-				}
-				else
-				{
-					switch (getSockErr())
-					{
-					case EAGAIN:
+		switch (getSockErr())
+		{
+		case EAGAIN:
 #if defined(EWOULDBLOCK) && EAGAIN != EWOULDBLOCK
-					case EWOULDBLOCK:
-#endif
-						if (!connectionIsOpen(sock))
-						{
-							debug(LOG_NET, "Socket error");
-							sock->writeError = true;
-							socketThreadWrites.erase(w);  // Socket broken, don't try writing to it again.
-							if (sock->deleteLater)
-							{
-								socketCloseNow(sock);
-							}
-							break;
-						}
-					case EINTR:
-						break;
+		case EWOULDBLOCK:
+#endif
+			if (!connectionIsOpen(sock))
+			{
+				debug(LOG_NET, "Socket error");
+				sock->writeError = true;
+				socketThreadRemoveWriteQueue(w);  // Socket broken, don't try writing to it again.
+			}
+			return;  // Socket buffer full, try again when it's writable.
+		case EINTR:
+			continue;
 #if defined(EPIPE)
-					case EPIPE:
-#endif
-					default:
-						sock->writeError = true;
-						socketThreadWrites.erase(w);  // Socket broken, don't try writing to it again.
-						if (sock->deleteLater)
-						{
-							socketCloseNow(sock);
-						}
-						break;
-					}
-				}
+		case EPIPE:
+#endif
+		default:
+			sock->writeError = true;
+			socketThreadRemoveWriteQueue(w);  // Socket broken, don't try writing to it again.
+			return;
+		}
+	}
+
+	socketThreadRemoveWriteQueue(w);  // Nothing left to write, delete from pending list.
+}
+
+/**
+ * Compresses size bytes of data into sock->zDeflateOutBuf. Only called by the socket thread.
+ */
+static void socketDeflate(Socket *sock, uint8_t const *data, size_t size, int flush)
+{
+#if ZLIB_VERNUM < 0x1252
+	// zlib < 1.2.5.2 does not support `#define ZLIB_CONST`
+	// Unfortunately, some OSes (ex. OpenBSD) ship with zlib < 1.2.5.2
+	// Workaround: cast away the const of the input, and disable the resulting -Wcast-qual warning
+	#if defined(__clang__)
+	#  pragma clang diagnostic push
+	#  pragma clang diagnostic ignored "-Wcast-qual"
+	#elif defined(__GNUC__)
+	#  pragma GCC diagnostic push
+	#  pragma GCC diagnostic ignored "-Wcast-qual"
+	#endif
+
+	// cast away the const for earlier zlib versions
+	sock->zDeflate.next_in = (Bytef *)data; // -Wcast-qual
+
+	#if defined(__clang__)
+	#  pragma clang diagnostic pop
+	#elif defined(__GNUC__)
+	#  pragma GCC diagnostic pop
+	#endif
+#else
+	// zlib >= 1.2.5.2 supports ZLIB_CONST
+	sock->zDeflate.next_in = (const Bytef *)data;
+#endif
+
+	sock->zDeflate.avail_in = size;
+	do
+	{
+		size_t alreadyHave = sock->zDeflateOutBuf.size();
+		sock->zDeflateOutBuf.resize(alreadyHave + size + 100);  // A bit more than size should be enough to always do everything, including flushing, in one go.
+		sock->zDeflate.next_out = (Bytef *)&sock->zDeflateOutBuf[alreadyHave];
+		sock->zDeflate.avail_out = sock->zDeflateOutBuf.size() - alreadyHave;
+
+		int ret = deflate(&sock->zDeflate, flush);
+		ASSERT(ret != Z_STREAM_ERROR, "zlib compression failed!");
+
+		// Remove unused part of buffer.
+		sock->zDeflateOutBuf.resize(sock->zDeflateOutBuf.size() - sock->zDeflate.avail_out);
+	}
+	while (sock->zDeflate.avail_out == 0);
+
+	ASSERT(sock->zDeflate.avail_in == 0, "zlib didn't compress everything!");
+}
+
+/**
+ * Compresses the data flushed on the sockets in socketThreadDeflateQueue, and queues the result for writing. Must be
+ * called with socketThreadMutex locked, which is unlocked while compressing.
+ */
+static void socketThreadDeflate()
+{
+	std::vector<SocketSharedBuffer> input;
+	while (!socketThreadDeflateQueue.empty())
+	{
+		Socket *sock = socketThreadDeflateQueue.front();
+		socketThreadDeflateQueue.pop_front();
+		sock->zDeflateFlushQueued = false;
+		sock->zDeflateBusy = true;
+		input.swap(sock->zDeflatePendingInput);
+
+		// The socket can't be deleted while zDeflateBusy is set, and the game thread only appends to zDeflatePendingInput.
+		wzMutexUnlock(socketThreadMutex);
+		for (std::vector<SocketSharedBuffer>::const_iterator i = input.begin(); i != input.end(); ++i)
+		{
+			socketDeflate(sock, (*i)->data(), (*i)->size(), Z_NO_FLUSH);
+		}
+		socketDeflate(sock, nullptr, 0, Z_PARTIAL_FLUSH);
+		input.clear();
+		wzMutexLock(socketThreadMutex);
+
+		sock->zDeflateBusy = false;
+		sock->zDeflateOutSize += sock->zDeflateOutBuf.size();
+		if (!sock->zDeflateOutBuf.empty() && !sock->writeError)
+		{
+			if (SocketWriteQueue *queue = socketThreadWriteQueue(sock))
+			{
+				queue->append(sock->zDeflateOutBuf.data(), sock->zDeflateOutBuf.size());
 			}
 		}
+		sock->zDeflateOutBuf.clear();
+
+		if (sock->deleteLater && !sock->zDeflateFlushQueued && socketThreadWrites.find(sock) == socketThreadWrites.end())
+		{
+			socketCloseNow(sock);  // socketClose() was called while compressing, and there is nothing left to write.
+		}
+	}
+}
+
+static int socketThreadFunction(void *)
+{
+	std::vector<Socket *> writable;
+
+	wzMutexLock(socketThreadMutex);
+	while (!socketThreadQuit)
+	{
+		socketThreadDeflate();
+
+		writable.clear();
+		socketThreadWaitWritable(writable);
 
-		if (socketThreadWrites.empty())
+		for (std::vector<Socket *>::const_iterator i = writable.begin(); i != writable.end(); ++i)
 		{
-			// Nothing to do, expect to wait.
-			wzMutexUnlock(socketThreadMutex);
-			wzSemaphoreWait(socketThreadSemaphore);
-			wzMutexLock(socketThreadMutex);
+			// The pending list may have changed while we were waiting, only write to sockets that are still in it.
+			SocketThreadWriteMap::iterator w = socketThreadWrites.find(*i);
+			if (w != socketThreadWrites.end())
+			{
+				socketThreadSend(w);
+			}
 		}
 	}
 	wzMutexUnlock(socketThreadMutex);
@@ -599,6 +968,32 @@ bool socketReadDisconnected(Socket *sock)
 	return sock->readDisconnected;
 }
 
+/**
+ * Queues data to be written to the socket. Uncompressed data is copied straight into the socket's write queue,
+ * compressed data is kept (shared, not copied) until socketFlush, and then compressed by the socket thread.
+ * Must be called with socketThreadMutex locked.
+ */
+static void socketQueueWrite(Socket *sock, uint8_t const *data, size_t size, SocketSharedBuffer const *shared)
+{
+	if (!sock->isCompressed)
+	{
+		if (SocketWriteQueue *queue = socketThreadWriteQueue(sock))
+		{
+			queue->append(data, size);
+		}
+		return;
+	}
+
+	if (shared != nullptr)
+	{
+		sock->zDeflatePendingInput.push_back(*shared);
+	}
+	else
+	{
+		sock->zDeflatePendingInput.push_back(std::make_shared<std::vector<uint8_t>>(data, data + size));
+	}
+}
+
 /**
  * Similar to write(2) with the exception that this function will block until
  * <em>all</em> data has been written or an error occurs.
@@ -625,121 +1020,68 @@ ssize_t writeAll(Socket *sock, const void *buf, size_t size, size_t *rawByteCoun
 
 	if (size > 0)
 	{
-		if (!sock->isCompressed)
-		{
-			wzMutexLock(socketThreadMutex);
-			if (socketThreadWrites.empty())
-			{
-				wzSemaphorePost(socketThreadSemaphore);
-			}
-			std::vector<uint8_t> &writeQueue = socketThreadWrites[sock];
-			writeQueue.insert(writeQueue.end(), static_cast<char const *>(buf), static_cast<char const *>(buf) + size);
-			wzMutexUnlock(socketThreadMutex);
-			rawBytes = size;
-		}
-		else
-		{
-		#if ZLIB_VERNUM < 0x1252
-			// zlib < 1.2.5.2 does not support `#define ZLIB_CONST`
-			// Unfortunately, some OSes (ex. OpenBSD) ship with zlib < 1.2.5.2
-			// Workaround: cast away the const of the input, and disable the resulting -Wcast-qual warning
-			#if defined(__clang__)
-			#  pragma clang diagnostic push
-			#  pragma clang diagnostic ignored "-Wcast-qual"
-			#elif defined(__GNUC__)
-			#  pragma GCC diagnostic push
-			#  pragma GCC diagnostic ignored "-Wcast-qual"
-			#endif
-
-			// cast away the const for earlier zlib versions
-			sock->zDeflate.next_in = (Bytef *)buf; // -Wcast-qual
-
-			#if defined(__clang__)
-			#  pragma clang diagnostic pop
-			#elif defined(__GNUC__)
-			#  pragma GCC diagnostic pop
-			#endif
-		#else
-			// zlib >= 1.2.5.2 supports ZLIB_CONST
-			sock->zDeflate.next_in = (const Bytef *)buf;
-		#endif
-
-			sock->zDeflate.avail_in = size;
-			sock->zDeflateInSize += sock->zDeflate.avail_in;
-			do
-			{
-				size_t alreadyHave = sock->zDeflateOutBuf.size();
-				sock->zDeflateOutBuf.resize(alreadyHave + size + 20);  // A bit more than size should be enough to always do everything in one go.
-				sock->zDeflate.next_out = (Bytef *)&sock->zDeflateOutBuf[alreadyHave];
-				sock->zDeflate.avail_out = sock->zDeflateOutBuf.size() - alreadyHave;
-
-				int ret = deflate(&sock->zDeflate, Z_NO_FLUSH);
-				ASSERT(ret != Z_STREAM_ERROR, "zlib compression failed!");
-
-				// Remove unused part of buffer.
-				sock->zDeflateOutBuf.resize(sock->zDeflateOutBuf.size() - sock->zDeflate.avail_out);
-			}
-			while (sock->zDeflate.avail_out == 0);
-
-			ASSERT(sock->zDeflate.avail_in == 0, "zlib didn't compress everything!");
-		}
+		wzMutexLock(socketThreadMutex);
+		socketQueueWrite(sock, static_cast<uint8_t const *>(buf), size, nullptr);
+		rawBytes = sock->isCompressed ? 0 : size;
+		wzMutexUnlock(socketThreadMutex);
 	}
 
 	return size;
 }
 
-void socketFlush(Socket *sock, size_t *rawByteCount)
+ssize_t writeAll(Socket *sock, SocketSharedBuffer const &buf, size_t *rawByteCount)
 {
 	size_t ignored;
 	size_t &rawBytes = rawByteCount != nullptr ? *rawByteCount : ignored;
 	rawBytes = 0;
 
-	if (!sock->isCompressed)
+	if (sock->fd[SOCK_CONNECTION] == INVALID_SOCKET)
 	{
-		return;  // Not compressed, so don't mess with zlib.
+		debug(LOG_ERROR, "Invalid socket (EBADF)");
+		setSockErr(EBADF);
+		return SOCKET_ERROR;
 	}
 
-	// Flush data out of zlib compression state.
-	do
+	if (sock->writeError)
 	{
-		sock->zDeflate.next_in = (Bytef *)nullptr;
-		sock->zDeflate.avail_in = 0;
-		size_t alreadyHave = sock->zDeflateOutBuf.size();
-		sock->zDeflateOutBuf.resize(alreadyHave + 1000);  // 100 bytes would probably be enough to flush the rest in one go.
-		sock->zDeflate.next_out = (Bytef *)&sock->zDeflateOutBuf[alreadyHave];
-		sock->zDeflate.avail_out = sock->zDeflateOutBuf.size() - alreadyHave;
-
-		int ret = deflate(&sock->zDeflate, Z_PARTIAL_FLUSH);
-		ASSERT(ret != Z_STREAM_ERROR, "zlib compression failed!");
+		return SOCKET_ERROR;
+	}
 
-		// Remove unused part of buffer.
-		sock->zDeflateOutBuf.resize(sock->zDeflateOutBuf.size() - sock->zDeflate.avail_out);
+	if (!buf->empty())
+	{
+		wzMutexLock(socketThreadMutex);
+		socketQueueWrite(sock, buf->data(), buf->size(), &buf);
+		rawBytes = sock->isCompressed ? 0 : buf->size();
+		wzMutexUnlock(socketThreadMutex);
 	}
-	while (sock->zDeflate.avail_out == 0);
 
-	if (sock->zDeflateOutBuf.empty())
+	return buf->size();
+}
+
+void socketFlush(Socket *sock, size_t *rawByteCount)
+{
+	size_t ignored;
+	size_t &rawBytes = rawByteCount != nullptr ? *rawByteCount : ignored;
+	rawBytes = 0;
+
+	if (!sock->isCompressed)
 	{
-		return;  // No data to flush out.
+		return;  // Not compressed, so don't mess with zlib.
 	}
 
 	wzMutexLock(socketThreadMutex);
-	if (socketThreadWrites.empty())
+	if (!sock->zDeflatePendingInput.empty() && !sock->zDeflateFlushQueued)
 	{
-		wzSemaphorePost(socketThreadSemaphore);
+		// Let the socket thread compress the data, so the caller doesn't have to wait for zlib.
+		sock->zDeflateFlushQueued = true;
+		socketThreadDeflateQueue.push_back(sock);
+		socketThreadWakeup();
 	}
-	std::vector<uint8_t> &writeQueue = socketThreadWrites[sock];
-	writeQueue.insert(writeQueue.end(), sock->zDeflateOutBuf.begin(), sock->zDeflateOutBuf.end());
-	wzMutexUnlock(socketThreadMutex);
 
-	// Primitive network logging, uncomment to use.
-	//printf("Size %3u ->%3zu, buf =", sock->zDeflateInSize, sock->zDeflateOutBuf.size());
-	//for (unsigned n = 0; n < std::min<unsigned>(sock->zDeflateOutBuf.size(), 40); ++n) printf(" %02X", sock->zDeflateOutBuf[n]);
-	//printf("\n");
-
-	// Data sent, don't send again.
-	rawBytes = sock->zDeflateOutBuf.size();
-	sock->zDeflateInSize = 0;
-	sock->zDeflateOutBuf.clear();
+	// The compressed size is only known once the socket thread has compressed the data, so report what has been compressed since the last call.
+	rawBytes = sock->zDeflateOutSize;
+	sock->zDeflateOutSize = 0;
+	wzMutexUnlock(socketThreadMutex);
 }
 
 void socketBeginCompression(Socket *sock)
@@ -925,12 +1267,6 @@ int checkSockets(const SocketSet *set, unsigned int timeout)
 		return 0;
 	}
 
-#if   defined(WZ_OS_UNIX)
-	SOCKET maxfd = INT_MIN;
-#elif defined(WZ_OS_WIN)
-	SOCKET maxfd = 0;
-#endif
-
 	bool compressedReady = false;
 	for (size_t i = 0; i < set->fds.size(); ++i)
 	{
@@ -941,8 +1277,6 @@ int checkSockets(const SocketSet *set, unsigned int timeout)
 			compressedReady = true;
 			break;
 		}
-
-		maxfd = std::max(maxfd, set->fds[i]->fd[SOCK_CONNECTION]);
 	}
 
 	if (compressedReady)
@@ -959,6 +1293,40 @@ int checkSockets(const SocketSet *set, unsigned int timeout)
 	}
 
 	int ret;
+#if defined(WZ_SOCKET_USE_POLL)
+	// Unlike select, poll has no FD_SETSIZE limit on the file descriptor values it can wait for.
+	std::vector<struct pollfd> fds(set->fds.size());
+	for (size_t i = 0; i < set->fds.size(); ++i)
+	{
+		fds[i].fd = set->fds[i]->fd[SOCK_CONNECTION];
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+
+	do
+	{
+		ret = poll(fds.data(), fds.size(), (int)timeout);
+	}
+	while (ret == SOCKET_ERROR && getSockErr() == EINTR);
+
+	if (ret == SOCKET_ERROR)
+	{
+		debug(LOG_ERROR, "poll failed: %s", strSockError(getSockErr()));
+		return SOCKET_ERROR;
+	}
+
+	for (size_t i = 0; i < set->fds.size(); ++i)
+	{
+		// Like select, report hangups and errors as readable, so that the following recv() notices them.
+		set->fds[i]->ready = (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+	}
+#else
+	SOCKET maxfd = 0;
+	for (size_t i = 0; i < set->fds.size(); ++i)
+	{
+		maxfd = std::max(maxfd, set->fds[i]->fd[SOCK_CONNECTION]);
+	}
+
 	fd_set fds;
 	do
 	{
@@ -986,6 +1354,7 @@ int checkSockets(const SocketSet *set, unsigned int timeout)
 	{
 		set->fds[i]->ready = FD_ISSET(set->fds[i]->fd[SOCK_CONNECTION], &fds);
 	}
+#endif
 
 	return ret;
 }
@@ -1102,7 +1471,7 @@ void socketClose(Socket *sock)
 {
 	wzMutexLock(socketThreadMutex);
 	//Instead of socketThreadWrites.erase(sock);, try sending the data before actually deleting.
-	if (socketThreadWrites.find(sock) != socketThreadWrites.end())
+	if (socketThreadWrites.find(sock) != socketThreadWrites.end() || sock->zDeflateFlushQueued || sock->zDeflateBusy)
 	{
 		// Wait until the data is written, then delete the socket.
 		sock->deleteLater = true;
@@ -1259,7 +1628,11 @@ Socket *socketOpen(const SocketAddress *addr, unsigned timeout)
 	ret = connect(conn->fd[SOCK_CONNECTION], addr->ai_addr, addr->ai_addrlen);
 	if (ret == SOCKET_ERROR)
 	{
+#if   defined(WZ_SOCKET_USE_POLL)
+		struct pollfd conReady;
+#else
 		fd_set conReady;
+#endif
 #if   defined(WZ_OS_WIN)
 		fd_set conFailed;
 #endif
@@ -1267,9 +1640,6 @@ Socket *socketOpen(const SocketAddress *addr, unsigned timeout)
 		if ((getSockErr() != EINPROGRESS
 		     && getSockErr() != EAGAIN
 		     && getSockErr() != EWOULDBLOCK)
-#if   defined(WZ_OS_UNIX)
-		    || conn->fd[SOCK_CONNECTION] >= FD_SETSIZE
-#endif
 		    || timeout == 0)
 		{
 			debug(LOG_NET, "Failed to start connecting: %s, using socket %p", strSockError(getSockErr()), static_cast<void *>(conn));
@@ -1279,6 +1649,12 @@ Socket *socketOpen(const SocketAddress *addr, unsigned timeout)
 
 		do
 		{
+#if   defined(WZ_SOCKET_USE_POLL)
+			conReady.fd = conn->fd[SOCK_CONNECTION];
+			conReady.events = POLLOUT;
+			conReady.revents = 0;
+			ret = poll(&conReady, 1, (int)timeout);
+#else
 			struct timeval tv = {(int)(timeout / 1000), (int)(timeout % 1000) * 1000};  // Cast to int to avoid narrowing needed for C++11.
 
 			FD_ZERO(&conReady);
@@ -1292,6 +1668,7 @@ Socket *socketOpen(const SocketAddress *addr, unsigned timeout)
 			ret = select(conn->fd[SOCK_CONNECTION] + 1, NULL, &conReady, &conFailed, &tv);
 #else
 			ret = select(conn->fd[SOCK_CONNECTION] + 1, nullptr, &conReady, nullptr, &tv);
+#endif
 #endif
 		}
 		while (ret == SOCKET_ERROR && getSockErr() == EINTR);
@@ -1313,6 +1690,8 @@ Socket *socketOpen(const SocketAddress *addr, unsigned timeout)
 
 #if   defined(WZ_OS_WIN)
 		ASSERT(FD_ISSET(conn->fd[SOCK_CONNECTION], &conReady) || FD_ISSET(conn->fd[SOCK_CONNECTION], &conFailed), "\"sock\" is the only file descriptor in set, it should be the one that is set.");
+#elif defined(WZ_SOCKET_USE_POLL)
+		ASSERT(conReady.revents != 0, "\"sock\" is the only file descriptor polled, it should be the one that is ready.");
 #else
 		ASSERT(FD_ISSET(conn->fd[SOCK_CONNECTION], &conReady), "\"sock\" is the only file descriptor in set, it should be the one that is set.");
 #endif
@@ -1693,6 +2072,28 @@ void SOCKETinit()
 		socketThreadQuit = false;
 		socketThreadMutex = wzMutexCreate();
 		socketThreadSemaphore = wzSemaphoreCreate(0);
+#if defined(WZ_SOCKET_USE_POLL)
+		createWakeupPipe(socketThreadWakeupPipe);
+#endif
+#if defined(WZ_SOCKET_USE_EPOLL)
+		socketThreadEpollFd = epoll_create1(EPOLL_CLOEXEC);
+		if (socketThreadEpollFd != -1)
+		{
+			struct epoll_event event;
+			memset(&event, 0, sizeof(event));
+			event.events = EPOLLIN;
+			event.data.ptr = nullptr;  // Marks the wakeup pipe.
+			if (socketThreadWakeupPipe[0] == -1 || epoll_ctl(socketThreadEpollFd, EPOLL_CTL_ADD, socketThreadWakeupPipe[0], &event) == -1)
+			{
+				close(socketThreadEpollFd);
+				socketThreadEpollFd = -1;
+			}
+		}
+		if (socketThreadEpollFd == -1)
+		{
+			debug(LOG_WARNING, "Failed to set up epoll, falling back to poll: %s", strSockError(getSockErr()));
+		}
+#endif
 		socketThread = wzThreadCreate(socketThreadFunction, nullptr);
 		wzThreadStart(socketThread);
 	}
@@ -1705,11 +2106,32 @@ void SOCKETshutdown()
 		wzMutexLock(socketThreadMutex);
 		socketThreadQuit = true;
 		socketThreadWrites.clear();
+		socketThreadDeflateQueue.clear();
 		wzMutexUnlock(socketThreadMutex);
 		wzSemaphorePost(socketThreadSemaphore);  // Wake up the thread, so it can quit.
+#if defined(WZ_SOCKET_USE_POLL)
+		socketThreadWritePipe();
+#endif
 		wzThreadJoin(socketThread);
 		wzMutexDestroy(socketThreadMutex);
 		wzSemaphoreDestroy(socketThreadSemaphore);
+#if defined(WZ_SOCKET_USE_EPOLL)
+		if (socketThreadEpollFd != -1)
+		{
+			close(socketThreadEpollFd);
+			socketThreadEpollFd = -1;
+		}
+#endif
+#if defined(WZ_SOCKET_USE_POLL)
+		for (int i = 0; i < 2; ++i)
+		{
+			if (socketThreadWakeupPipe[i] != -1)
+			{
+				close(socketThreadWakeupPipe[i]);
+				socketThreadWakeupPipe[i] = -1;
+			}
+		}
+#endif
 		socketThread = nullptr;
 	}
 
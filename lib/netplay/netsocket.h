@@ -24,6 +24,7 @@
 #include "lib/framework/types.h"
 #include <string>
 #include <vector>
+#include <memory>
 
 #if   defined(WZ_OS_UNIX)
 # include <arpa/inet.h>
@@ -75,6 +76,7 @@ static const SOCKET INVALID_SOCKET = -1;
 struct Socket;
 struct SocketSet;
 typedef struct addrinfo SocketAddress;
+typedef std::shared_ptr<std::vector<uint8_t> const> SocketSharedBuffer;  ///< Immutable data which can be queued on several Sockets without copying it for each.
 
 #ifndef WZ_OS_WIN
 static const int SOCKET_ERROR = -1;
@@ -117,11 +119,13 @@ WZ_DECL_NONNULL(1, 2)
 ssize_t readAll(Socket *sock, void *buf, size_t size, unsigned timeout);///< Reads exactly size bytes from the Socket, or blocks until the timeout expires.
 WZ_DECL_NONNULL(1, 2)
 ssize_t writeAll(Socket *sock, const void *buf, size_t size, size_t *rawByteCount = nullptr);  ///< Nonblocking write of size bytes to the Socket. All bytes will be written asynchronously, by a separate thread. Raw count of bytes (after compression) returned in rawByteCount, which will often be 0 until the socket is flushed.
+WZ_DECL_NONNULL(1)
+ssize_t writeAll(Socket *sock, SocketSharedBuffer const &buf, size_t *rawByteCount = nullptr);  ///< Same as writeAll above, except that compressed Sockets keep a reference to buf instead of copying it. For sending the same data to many Sockets.
 
 // Sockets, compressed.
 WZ_DECL_NONNULL(1) void socketBeginCompression(Socket *sock); ///< Makes future data sent compressed, and future data received expected to be compressed.
 WZ_DECL_NONNULL(1) bool socketReadDisconnected(Socket *sock);  ///< If readNoInt returned 0, returns true if this is the result of a disconnect, or false if the input compressed data just hasn't produced any output bytes.
-WZ_DECL_NONNULL(1) void socketFlush(Socket *sock, size_t *rawByteCount = nullptr); ///< Actually sends the data written with writeAll. Only useful on compressed sockets. Note that flushing too often makes compression less effective. Raw count of bytes (after compression) returned in rawByteCount.
+WZ_DECL_NONNULL(1) void socketFlush(Socket *sock, size_t *rawByteCount = nullptr); ///< Actually sends the data written with writeAll. Only useful on compressed sockets. Note that flushing too often makes compression less effective. The data is compressed asynchronously, by a separate thread, so the raw count of bytes (after compression) returned in rawByteCount is for data flushed by earlier calls.
 
 // Socket sets.
 WZ_DECL_ALLOCATION SocketSet *allocSocketSet();                         ///< Constructs a SocketSet.
@@ -265,6 +265,28 @@ static void queue(const Q &q, std::vector<T> &v)
 	}
 }
 
+static void queueData(const MessageWriter &q, std::vector<uint8_t> &v, uint32_t len)
+{
+	q.bytes(v.data(), len);
+}
+
+static void queueData(const MessageReader &q, std::vector<uint8_t> &v, uint32_t len)
+{
+	// Don't trust len further than the message data, a truncated message gets one (invalid) zero byte, like reading each byte would.
+	size_t readable = q.valid() ? q.message->data.size() - q.index + 1 : 0;
+	v.resize(std::min<size_t>(len, readable));
+	q.bytes(v.data(), v.size());
+}
+
+template<class Q>
+static void queue(const Q &q, std::vector<uint8_t> &v)
+{
+	ASSERT(v.size() <= static_cast<size_t>(std::numeric_limits<uint32_t>::max()), "v.size() exceeds uint32_t max");
+	uint32_t len = static_cast<uint32_t>(std::min(v.size(), static_cast<size_t>(std::numeric_limits<uint32_t>::max())));
+	queue(q, len);
+	queueData(q, v, len);  // Copy the whole array at once, instead of byte by byte.
+}
+
 template<class Q>
 static void queue(const Q &q, NetMessage &v)
 {
@@ -285,6 +307,19 @@ static void queueAuto(T &v)
 	}
 }
 
+/// Same as queueAuto on each byte in turn, but copies all the bytes at once.
+static void queueAutoBytes(uint8_t *v, size_t n)
+{
+	if (NETgetPacketDir() == PACKET_ENCODE)
+	{
+		writer.bytes(v, n);
+	}
+	else if (NETgetPacketDir() == PACKET_DECODE)
+	{
+		reader.bytes(v, n);
+	}
+}
+
 // Queue selection functions
 
 /// Gets the &NetQueuePair::send or NetQueue *, corresponding to queue.
@@ -455,7 +490,8 @@ void NETbeginEncode(NETQUEUE queue, uint8_t type)
 	NETsetPacketDir(PACKET_ENCODE);
 
 	queueInfo = queue;
-	message = type;
+	message.type = type;
+	message.data.clear();  // Keeps the capacity from earlier messages.
 	writer = MessageWriter(message);
 }
 
@@ -464,10 +500,11 @@ void NETbeginDecode(NETQUEUE queue, uint8_t type)
 	NETsetPacketDir(PACKET_DECODE);
 
 	queueInfo = queue;
-	message = receiveQueue(queueInfo)->getMessage();
-	reader = MessageReader(message);
+	// Read the message in place, it stays in the queue until NETpop().
+	NetMessage const &queuedMessage = receiveQueue(queueInfo)->getMessage();
+	reader = MessageReader(queuedMessage);
 
-	assert(type == message.type);
+	assert(type == queuedMessage.type);
 }
 
 bool NETend()
@@ -667,10 +704,7 @@ void NETstring(char *str, uint16_t maxlen)
 		len = maxlen - 1;
 	}
 
-	for (unsigned i = 0; i < len; ++i)
-	{
-		queueAuto(str[i]);
-	}
+	queueAutoBytes(reinterpret_cast<uint8_t *>(str), len);
 
 	if (NETgetPacketDir() == PACKET_DECODE)
 	{
@@ -749,18 +783,12 @@ void NETbytes(std::vector<uint8_t> *vec, unsigned maxLen)
 		vec->resize(len);  // vec->assign(len, 0) would call the wrong version of assign, here.
 	}
 
-	for (unsigned i = 0; i < len; ++i)
-	{
-		queueAuto((*vec)[i]);
-	}
+	queueAutoBytes(vec->data(), len);
 }
 
 void NETbin(uint8_t *str, uint32_t len)
 {
-	for (unsigned i = 0; i < len; ++i)
-	{
-		queueAuto(str[i]);
-	}
+	queueAutoBytes(str, len);
 }
 
 void NETPosition(Position *vp)
@@ -686,6 +686,11 @@ void wzMutexUnlock(WZ_MUTEX *mutex)
 	SDL_UnlockMutex((SDL_mutex *)mutex);
 }
 
+bool wzMutexTryLock(WZ_MUTEX *mutex)
+{
+	return SDL_TryLockMutex((SDL_mutex *)mutex) == 0;
+}
+
 WZ_SEMAPHORE *wzSemaphoreCreate(int startValue)
 {
 	return (WZ_SEMAPHORE *)SDL_CreateSemaphore(startValue);
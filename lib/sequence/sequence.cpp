@@ -79,6 +79,14 @@
 #include <AL/al.h>
 
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/wzapp.h"
+
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SEQ_YUV_SSE2
+#endif
 
 // stick this in sequence.h perhaps?
 struct AudioData
@@ -122,13 +130,12 @@ static int vorbis_p = 0;
 
 static bool stateflag = false;
 static bool videoplaying = false;
-static bool videobuf_ready = false;		// single frame video buffer ready for processing
+static bool videobuf_ready = false;		// a decoded video frame is waiting in videoQueue
 static bool audiobuf_ready = false;		// single 'frame' audio buffer ready for processing
 
 // file handle
 static PHYSFS_file *fpInfile = nullptr;
 
-static uint32_t *RGBAframe = nullptr;					// texture buffer
 static ogg_int16_t *audiobuf = nullptr;			// audio buffer
 
 // For timing
@@ -142,7 +149,6 @@ static double timer_expire;
 static bool timer_started = false;
 
 static ogg_int64_t audiobuf_granulepos = 0;	// time position of last sample
-static ogg_int64_t videobuf_granulepos = -1;	// time position of last video frame
 
 // frame & dropped frame counter
 static int frames = 0;
@@ -157,6 +163,27 @@ static gfx_api::gfxFloat Scrnvidpos[3];
 static SCANLINE_MODE use_scanlines;
 static bool scanlinesDisabled = false;
 
+// The video is decoded and converted to RGBA on its own thread, a few frames ahead of playback.
+// The main thread only uploads the frames when they are due.
+#define VIDEO_QUEUE_SIZE 3
+struct VideoFrame
+{
+	uint32_t *RGBAframe = nullptr;	// texture buffer
+	double time = 0;				// when to show the frame
+};
+static VideoFrame videoQueue[VIDEO_QUEUE_SIZE];
+static int videoQueueHead = 0;		// oldest frame, which belongs to the main thread while videoQueueCount > 0
+static int videoQueueCount = 0;
+static SCANLINE_MODE videoScanMode = SCANLINES_OFF;	// scanline mode of the current video
+
+static WZ_THREAD *videoDecodeThread = nullptr;
+static WZ_SEMAPHORE *videoDecodeSemaphore = nullptr;	// wakes the decode thread when there are new packets or free frames
+static WZ_MUTEX *videoMutex = nullptr;	// guards videodata.to, videoQueueHead/Count and the variables below
+static bool videoDecodeQuit = false;
+static bool videoNeedsData = false;		// the decode thread ran out of Theora packets
+static double videoClock = 0;			// getRelativeTime(), as last seen by the main thread
+static double videoLastShown = 0;		// last_time, as last seen by the main thread
+
 // Helper; just grab some more compressed bitstream and sync it for page extraction
 static int buffer_data(PHYSFS_file *in, ogg_sync_state *oy)
 {
@@ -267,20 +294,25 @@ const size_t texture_height = 1024;
 static void Allocate_videoFrame(void)
 {
 	int size = videodata.ti.frame_width * videodata.ti.frame_height * 4;
-	if (!seq_getScanlinesDisabled() && seq_getScanlineMode())
+	if (videoScanMode)
 	{
 		size *= 2;
 	}
 
-	RGBAframe = (uint32_t *)malloc(size);
-	memset(RGBAframe, 0, size);
+	for (VideoFrame &frame : videoQueue)
+	{
+		frame.RGBAframe = (uint32_t *)calloc(1, size);
+	}
+	videoQueueHead = 0;
+	videoQueueCount = 0;
 }
 
 static void deallocateVideoFrame(void)
 {
-	if (RGBAframe)
+	for (VideoFrame &frame : videoQueue)
 	{
-		free(RGBAframe);
+		free(frame.RGBAframe);
+		frame.RGBAframe = nullptr;
 	}
 }
 
@@ -301,87 +333,198 @@ const int RGBmask = 0x7f7f7f00;
 const int Amask = 0x000000ff;
 #endif
 #define Vclip( x )	( (x > 0) ? ((x < 255) ? x : 255) : 0 )
-// main routine to display video on screen.
-static void video_write(bool update)
+
+/// Converts one row of 4:2:0 video to RGBA, two pixels for each chroma sample.
+static void yuvRowToRGBA(const unsigned char *yRow, const unsigned char *uRow, const unsigned char *vRow, uint32_t *rgbaRow, int half_width)
+{
+	int x = 0;
+#ifdef SEQ_YUV_SSE2
+	// Same integer formula as the scalar loop below, 8 pixels at a time, so the output is identical.
+	// The packs saturate to 0..255, which is what Vclip does.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias16 = _mm_set1_epi16(16);
+	const __m128i bias128 = _mm_set1_epi16(128);
+	const __m128i round = _mm_set1_epi32(128);
+	const __m128i coefYV = _mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409);
+	const __m128i coefYUg = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+	const __m128i coefYUb = _mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516);
+	const __m128i coefV = _mm_setr_epi16(409, 0, 409, 0, 409, 0, 409, 0);
+	const __m128i alpha = _mm_set1_epi8(-1);
+	for (; x + 4 <= half_width; x += 4)
+	{
+		int32_t u4, v4;
+		memcpy(&u4, uRow + x, sizeof(u4));
+		memcpy(&v4, vRow + x, sizeof(v4));
+		const __m128i Y = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(yRow + 2 * x)), zero), bias16);
+		__m128i U = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero), bias128);
+		__m128i V = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero), bias128);
+		U = _mm_unpacklo_epi16(U, U);  // each chroma sample is used by two pixels
+		V = _mm_unpacklo_epi16(V, V);
+
+		__m128i R[2], G[2], B[2];
+		for (int half = 0; half < 2; ++half)
+		{
+			const __m128i YU = half ? _mm_unpackhi_epi16(Y, U) : _mm_unpacklo_epi16(Y, U);
+			const __m128i YV = half ? _mm_unpackhi_epi16(Y, V) : _mm_unpacklo_epi16(Y, V);
+			const __m128i V0 = half ? _mm_unpackhi_epi16(V, zero) : _mm_unpacklo_epi16(V, zero);
+			const __m128i C = _mm_madd_epi16(V0, coefV);
+			R[half] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(YV, coefYV), round), 8);
+			G[half] = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_madd_epi16(YU, coefYUg), _mm_srai_epi32(C, 1)), round), 8);
+			B[half] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(YU, coefYUb), round), 8);
+		}
+		const __m128i R8 = _mm_packus_epi16(_mm_packs_epi32(R[0], R[1]), zero);
+		const __m128i G8 = _mm_packus_epi16(_mm_packs_epi32(G[0], G[1]), zero);
+		const __m128i B8 = _mm_packus_epi16(_mm_packs_epi32(B[0], B[1]), zero);
+		const __m128i RG = _mm_unpacklo_epi8(R8, G8);
+		const __m128i BA = _mm_unpacklo_epi8(B8, alpha);
+		_mm_storeu_si128((__m128i *)(rgbaRow + 2 * x), _mm_unpacklo_epi16(RG, BA));
+		_mm_storeu_si128((__m128i *)(rgbaRow + 2 * x + 4), _mm_unpackhi_epi16(RG, BA));
+	}
+#endif
+	for (; x < half_width; x++)
+	{
+		const int U = uRow[x] - 128;
+		const int V = vRow[x] - 128;
+		const int C = 409 * V;
+
+		// second pixel, U and V (and thus C) are the same as before.
+		for (int i = 0; i < 2; i++)
+		{
+			const int A = 298 * (yRow[2 * x + i] - 16);
+
+			const int R = Vclip((A + C + 128) >> 8);
+			const int G = Vclip((A - 100 * U - (C >> 1) + 128) >> 8);
+			const int B = Vclip((A + 516 * U + 128) >> 8);
+
+			rgbaRow[2 * x + i] = (R << Rshift) | (G << Gshift) | (B << Bshift) | (0xFF << Ashift);
+		}
+	}
+}
+
+/// Fills an RGBA frame from the decoded YUV frame, adding the scanlines if enabled.
+static void convertVideoFrame(const yuv_buffer &yuv, uint32_t *RGBAframe)
 {
-	unsigned int x = 0, y = 0;
 	const int video_width = videodata.ti.frame_width;
 	const int video_height = videodata.ti.frame_height;
-	SCANLINE_MODE scanMode = seq_getScanlinesDisabled() ? SCANLINES_OFF : seq_getScanlineMode();
+	const int half_width = video_width / 2;
 	// when using scanlines we need to double the height
-	const int height_factor = (scanMode ? 2 : 1);
-	yuv_buffer yuv;
+	const int height_factor = (videoScanMode ? 2 : 1);
 
-	if (update)
+	for (int y = 0; y < video_height; y++)
 	{
-		int rgb_offset = 0;
-		int y_offset = 0;
-		int uv_offset = 0;
-		const int half_width = video_width / 2;
-
-		theora_decode_YUVout(&videodata.td, &yuv);
+		uint32_t *row = RGBAframe + y * video_width * height_factor;
+		yuvRowToRGBA(yuv.y + y * yuv.y_stride, yuv.u + (y >> 1) * yuv.uv_stride, yuv.v + (y >> 1) * yuv.uv_stride, row, half_width);
 
-		// fill the RGBA buffer
-		for (y = 0; y < video_height; y++)
+		for (int x = 0; x < half_width * 2; x++)
 		{
-			y_offset = y * yuv.y_stride;
-			uv_offset = (y >> 1) * yuv.uv_stride;
-
-			for (x = 0; x < half_width; x++)
+			if (videoScanMode == SCANLINES_50)
 			{
-				int Y = yuv.y[y_offset++] - 16;
-				const int U = yuv.u[uv_offset] - 128;
-				const int V = yuv.v[uv_offset++] - 128;
-
-				int A = 298 * Y;
-				const int C = 409 * V;
-
-				int R = Vclip((A + C + 128) >> 8);
-				int G = Vclip((A - 100 * U - (C >> 1) + 128) >> 8);
-				int B = Vclip((A + 516 * U + 128) >> 8);
+				// halve the rgb values for a dimmed scanline
+				row[x + video_width] = (row[x] >> 1 & RGBmask) | Amask;
+			}
+			else if (videoScanMode == SCANLINES_BLACK)
+			{
+				row[x + video_width] = Amask;
+			}
+		}
+	}
+}
 
-				uint32_t rgba = (R << Rshift) | (G << Gshift) | (B << Bshift) | (0xFF << Ashift);
+// This function runs in a separate thread!
+// Decodes Theora packets and converts the frames into free slots of videoQueue.
+static int videoDecodeThreadFunc(WZ_DECL_UNUSED void *data)
+{
+	std::vector<unsigned char> packetData;
+	bool quit = false;
+	while (!quit)
+	{
+		wzSemaphoreWait(videoDecodeSemaphore);	// Go to sleep until needed.
+		wzMutexLock(videoMutex);
+		while (!videoDecodeQuit && videoQueueCount < VIDEO_QUEUE_SIZE)
+		{
+			ogg_packet op;
+			if (ogg_stream_packetout(&videodata.to, &op) <= 0)
+			{
+				videoNeedsData = true;
+				break;
+			}
+			// The packet points into the stream, which the main thread keeps adding pages to.
+			packetData.assign(op.packet, op.packet + op.bytes);
+			op.packet = packetData.data();
+			const int slot = (videoQueueHead + videoQueueCount) % VIDEO_QUEUE_SIZE;
+			wzMutexUnlock(videoMutex);
 
-				RGBAframe[rgb_offset] = rgba;
-				if (scanMode == SCANLINES_50)
-				{
-					// halve the rgb values for a dimmed scanline
-					RGBAframe[rgb_offset + video_width] = (rgba >> 1 & RGBmask) | Amask;
-				}
-				else if (scanMode == SCANLINES_BLACK)
-				{
-					RGBAframe[rgb_offset + video_width] = Amask;
-				}
-				rgb_offset++;
+			/* theora is one in, one out... */
+			theora_decode_packetin(&videodata.td, &op);
+			const double frameTime = theora_granule_time(&videodata.td, videodata.td.granulepos);
 
-				// second pixel, U and V (and thus C) are the same as before.
-				Y = yuv.y[y_offset++] - 16;
-				A = 298 * Y;
+			wzMutexLock(videoMutex);
+			// running slow, so we skip this frame
+			const bool show = frameTime >= videoClock || videoClock - videoLastShown >= 1.0;
+			wzMutexUnlock(videoMutex);
 
-				R = Vclip((A + C + 128) >> 8);
-				G = Vclip((A - 100 * U - (C >> 1) + 128) >> 8);
-				B = Vclip((A + 516 * U + 128) >> 8);
+			if (show)
+			{
+				yuv_buffer yuv;
+				theora_decode_YUVout(&videodata.td, &yuv);
+				convertVideoFrame(yuv, videoQueue[slot].RGBAframe);
+				videoQueue[slot].time = frameTime;
+			}
 
-				rgba = (R << Rshift) | (G << Gshift) | (B << Bshift) | (0xFF << Ashift);
-				RGBAframe[rgb_offset] = rgba;
-				if (scanMode == SCANLINES_50)
-				{
-					// halve the rgb values for a dimmed scanline
-					RGBAframe[rgb_offset + video_width] = (rgba >> 1 & RGBmask) | Amask;
-				}
-				else if (scanMode == SCANLINES_BLACK)
-				{
-					RGBAframe[rgb_offset + video_width] = Amask;
-				}
-				rgb_offset++;
+			wzMutexLock(videoMutex);
+			if (show)
+			{
+				++videoQueueCount;
 			}
-			if (scanMode)
+			else
 			{
-				rgb_offset += video_width;
+				dropped++;
 			}
 		}
+		quit = videoDecodeQuit;
+		wzMutexUnlock(videoMutex);
+	}
+	return 0;
+}
 
-		videoGfx->updateTexture(RGBAframe, static_cast<size_t>(video_width), static_cast<size_t>(video_height) * static_cast<size_t>(height_factor));
+static void startVideoDecodeThread(void)
+{
+	videoDecodeQuit = false;
+	videoNeedsData = false;
+	videoClock = 0;
+	videoLastShown = 0;
+	videoMutex = wzMutexCreate();
+	videoDecodeSemaphore = wzSemaphoreCreate(1);
+	videoDecodeThread = wzThreadCreate(videoDecodeThreadFunc, nullptr);
+	wzThreadStart(videoDecodeThread);
+}
+
+static void stopVideoDecodeThread(void)
+{
+	if (videoDecodeThread == nullptr)
+	{
+		return;
+	}
+	wzMutexLock(videoMutex);
+	videoDecodeQuit = true;
+	wzMutexUnlock(videoMutex);
+	wzSemaphorePost(videoDecodeSemaphore);
+	wzThreadJoin(videoDecodeThread);
+	videoDecodeThread = nullptr;
+	wzSemaphoreDestroy(videoDecodeSemaphore);
+	videoDecodeSemaphore = nullptr;
+	wzMutexDestroy(videoMutex);
+	videoMutex = nullptr;
+}
+
+// main routine to display video on screen, uploading RGBAframe first if it is not null.
+static void video_write(const uint32_t *RGBAframe)
+{
+	if (RGBAframe)
+	{
+		// when using scanlines we need to double the height
+		const size_t height_factor = (videoScanMode ? 2 : 1);
+		videoGfx->updateTexture(RGBAframe, static_cast<size_t>(videodata.ti.frame_width), static_cast<size_t>(videodata.ti.frame_height) * height_factor);
 	}
 
 	const auto& modelViewProjectionMatrix = glm::ortho(0.f, static_cast<float>(pie_GetVideoBufferWidth()), static_cast<float>(pie_GetVideoBufferHeight()), 0.f) *
@@ -462,7 +605,6 @@ static void seq_InitOgg(void)
 
 	/* single frame video buffering */
 	videobuf_ready = false;
-	videobuf_granulepos = -1;
 	videobuf_time = 0;
 	frames = 0;
 	dropped = 0;
@@ -701,17 +843,20 @@ bool seq_Play(const char *filename)
 		{
 			seq_setScanlinesDisabled(true);
 		}
+		videoScanMode = seq_getScanlinesDisabled() ? SCANLINES_OFF : seq_getScanlineMode();
 
 		Allocate_videoFrame();
 		videoGfx->makeTexture(texture_width, texture_height, gfx_api::pixel_format::FORMAT_RGBA8_UNORM_PACK8, blackframe);
 		free(blackframe);
 
 		// when using scanlines we need to double the height
-		const uint32_t height_factor = ((!seq_getScanlinesDisabled() && seq_getScanlineMode()) ? 2 : 1);
+		const uint32_t height_factor = (videoScanMode ? 2 : 1);
 		const gfx_api::gfxFloat vtwidth = (float)videodata.ti.frame_width / (float)texture_width;
 		const gfx_api::gfxFloat vtheight = (float)videodata.ti.frame_height * height_factor / (float)texture_height;
 		gfx_api::gfxFloat texcoords[NUM_VERTICES * 2] = { 0.0f, 0.0f, vtwidth, 0.0f, 0.0f, vtheight, vtwidth, vtheight };
 		videoGfx->buffers(NUM_VERTICES, vertices, texcoords);
+
+		startVideoDecodeThread();
 	}
 
 	/* on to the main decode loop.  We assume in this example that audio
@@ -814,58 +959,57 @@ bool seq_Update()
 		}
 	}
 
-	while (theora_p && !videobuf_ready)
+	bool videoWantsData = false;
+	if (theora_p)
 	{
-		/* theora is one in, one out... */
-		if (ogg_stream_packetout(&videodata.to, &op) > 0)
+		wzMutexLock(videoMutex);
+		videoClock = getRelativeTime();
+		videoLastShown = last_time;
+		videobuf_ready = videoQueueCount > 0;
+		if (videobuf_ready)
 		{
-			double now_time = 0;
-			double delay = 0;
-
-			theora_decode_packetin(&videodata.td, &op);
-			videobuf_granulepos = videodata.td.granulepos;
-			videobuf_time = theora_granule_time(&videodata.td, videobuf_granulepos);
-
-			now_time = getRelativeTime();
-			delay = videobuf_time - getRelativeTime();
-
-			if ((delay >= 0.0f) || (now_time - last_time >= 1.0f))
-			{
-				videobuf_ready = true;
-				seq_SetFrameNumber(seq_GetFrameNumber() + 1);
-			}
-			else
-			{
-				// running slow, so we skip this frame
-				dropped++;
-			}
-		}
-		else
-		{
-			break;
+			videobuf_time = videoQueue[videoQueueHead].time;
 		}
+		videoWantsData = videoNeedsData;
+		wzMutexUnlock(videoMutex);
 	}
 
 	alGetSourcei(audiodata.source, AL_SOURCE_STATE, &sourcestate);
 
 	if (PHYSFS_eof(fpInfile)
 		&& !videobuf_ready
+		&& (!theora_p || videoWantsData)
 		&& ((!audiobuf_ready && (audiodata.audiobuf_fill == 0)) || audio_Disabled())
 		&& sourcestate != AL_PLAYING)
 	{
-		video_write(false);
+		video_write(nullptr);
 		seq_Shutdown();
 		debug(LOG_VIDEO, "video finished");
 		return false;
 	}
 
-	if (!videobuf_ready || !audiobuf_ready)
+	if (videoWantsData || !audiobuf_ready)
 	{
 		/* no data yet for somebody.  Grab another page */
 		ret = buffer_data(fpInfile, &videodata.oy);
+		bool queued = false;
+		if (theora_p)
+		{
+			wzMutexLock(videoMutex);
+		}
 		while (ogg_sync_pageout(&videodata.oy, &videodata.og) > 0)
 		{
 			queue_page(&videodata.og);
+			queued = true;
+		}
+		if (theora_p)
+		{
+			videoNeedsData = videoNeedsData && !queued;
+			wzMutexUnlock(videoMutex);
+			if (queued)
+			{
+				wzSemaphorePost(videoDecodeSemaphore);
+			}
 		}
 	}
 
@@ -882,13 +1026,21 @@ bool seq_Update()
 	/* are we at or past time for this video frame? */
 	if (stateflag && videobuf_ready && (videobuf_time <= getRelativeTime()))
 	{
-		video_write(true);
+		video_write(videoQueue[videoQueueHead].RGBAframe);
 		last_time = getRelativeTime();
 		videobuf_ready = false;
+		seq_SetFrameNumber(seq_GetFrameNumber() + 1);
+
+		// Hand the frame back to the decode thread.
+		wzMutexLock(videoMutex);
+		videoQueueHead = (videoQueueHead + 1) % VIDEO_QUEUE_SIZE;
+		--videoQueueCount;
+		wzMutexUnlock(videoMutex);
+		wzSemaphorePost(videoDecodeSemaphore);
 	}
 	else if (stateflag)
 	{
-		video_write(false);
+		video_write(nullptr);
 	}
 
 	/* if our buffers either don't exist or are ready to go,
@@ -938,6 +1090,7 @@ void seq_Shutdown()
 
 	if (theora_p)
 	{
+		stopVideoDecodeThread();
 		ogg_stream_clear(&videodata.to);
 		theora_clear(&videodata.td);
 		theora_comment_clear(&videodata.tc);
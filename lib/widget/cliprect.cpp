@@ -49,9 +49,15 @@ bool ClipRectWidget::processClickRecursive(W_CONTEXT *psContext, WIDGET_KEY key,
 
 void ClipRectWidget::displayRecursive(const WidgetGraphicsContext &context)
 {
+	if (context.isClipped() && !context.clipIntersects(subtreeBounds()))
+	{
+		return;
+	}
+
 	if (context.clipContains(geometry()))
 	{
 		display(context.getXOffset(), context.getYOffset());
+		countDisplay();
 	}
 
 	auto childrenContext = context
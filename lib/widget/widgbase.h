@@ -30,6 +30,7 @@
 #include <vector>
 #include <functional>
 #include <string>
+#include <unordered_map>
 #include "lib/framework/geometry.h"
 #include "lib/framework/wzstring.h"
 
@@ -125,8 +126,16 @@ public:
 		return offset.y;
 	}
 
+	bool isClipped() const
+	{
+		return clipped;
+	}
+
 	bool clipContains(WzRect const& rect) const;
 
+	/// Whether some rectangle inside rect could pass clipContains. Always true when not clipped.
+	bool clipIntersects(WzRect const& rect) const;
+
 	WidgetGraphicsContext translatedBy(int32_t x, int32_t y) const;
 
 	WidgetGraphicsContext clippedBy(WzRect const &newRect) const;
@@ -207,6 +216,7 @@ public:
 			}
 		}
 		childWidgets = {};
+		invalidateSubtreeBounds();
 	}
 	WzRect const &geometry() const
 	{
@@ -305,11 +315,15 @@ private:
 	WIDGET_ONDELETE_FUNC	onDelete;				///< Optional callback called when the Widget is about to be deleted
 	WIDGET_HITTEST_FUNC		customHitTest;			///< Optional hit-testing custom function
 	void setScreenPointer(const std::shared_ptr<W_SCREEN> &screen); ///< Set screen pointer for us and all children.
+	void invalidateSubtreeBounds();  ///< Marks the subtree bounds of us and all parents as out of date.
+protected:
+	void countDisplay();  ///< Counts us for widgGetResetDisplayCounts() after being drawn, and clears dirty.
 public:
 	virtual bool processClickRecursive(W_CONTEXT *psContext, WIDGET_KEY key, bool wasPressed);
 	void runRecursive(W_CONTEXT *psContext);
 	void processCallbacksRecursive(W_CONTEXT *psContext);
 	virtual void displayRecursive(WidgetGraphicsContext const &context);  ///< Display this widget, and all visible children.
+	WzRect const &subtreeBounds();  ///< Bounding box of this widget and all its children, in the same coordinates as geometry().
 	void displayRecursive()
 	{
 		WidgetGraphicsContext context;
@@ -322,6 +336,8 @@ private:
 
 	WzRect                  dim;
 	bool					isTransparentToClicks = false;
+	WzRect                  cachedSubtreeBounds;
+	bool                    subtreeBoundsDirty = true;
 
 	WIDGET(WIDGET const &) = delete;
 	WIDGET &operator =(WIDGET const &) = delete;
@@ -365,6 +381,10 @@ public:
 	std::weak_ptr<WIDGET> lastHighlight; ///< The last widget to be highlighted. This is used to track when the mouse moves off something.
 	iV_fonts         TipFontID;     ///< ID of the IVIS font to use for tool tips.
 	WidgetTriggers   retWidgets;    ///< The widgets to be returned by widgRunScreen.
+	/// The first widget in tree order with each id, as widgFormGetFromID would find it, or no widget if the id is used more than once.
+	/// Rebuilt by widgGetFromID after widgets joined or left the screen.
+	std::unordered_map<UDWORD, std::weak_ptr<WIDGET>> widgetsById;
+	bool             widgetsByIdValid = false;  ///< Cleared whenever a widget joins or leaves the screen.
 
 	std::shared_ptr<WIDGET> getWidgetWithFocus() const
 	{
@@ -69,6 +69,9 @@ static std::vector<std::function<void()>> widgetScheduledTasks;
 
 static bool debugBoundingBoxesOnly = false;
 
+static size_t widgetsDisplayed = 0;  ///< Widgets drawn since widgGetResetDisplayCounts()
+static size_t widgetsChanged = 0;    ///< Of widgetsDisplayed, those marked dirty since they were last drawn
+
 #ifdef DEBUG
 #include "lib/framework/demangle.hpp"
 static std::unordered_set<const WIDGET*> debugLiveWidgets;
@@ -422,6 +425,7 @@ void WIDGET::setGeometry(WzRect const &r)
 		return;  // Nothing to do.
 	}
 	dim = r;
+	invalidateSubtreeBounds();
 	geometryChanged();
 	dirty = true;
 }
@@ -478,6 +482,7 @@ void WIDGET::attach(const std::shared_ptr<WIDGET> &widget)
 	widget->parentWidget = shared_from_this();
 	widget->setScreenPointer(screenPointer.lock());
 	childWidgets.push_back(widget);
+	invalidateSubtreeBounds();
 }
 
 void WIDGET::detach(const std::shared_ptr<WIDGET> &widget)
@@ -487,6 +492,7 @@ void WIDGET::detach(const std::shared_ptr<WIDGET> &widget)
 	widget->parentWidget.reset();
 	widget->setScreenPointer(nullptr);
 	childWidgets.erase(std::find(childWidgets.begin(), childWidgets.end(), widget));
+	invalidateSubtreeBounds();
 
 	widgetLost(widget.get());
 }
@@ -505,6 +511,7 @@ void WIDGET::setScreenPointer(const std::shared_ptr<W_SCREEN> &screen)
 
 	if (auto lockedScreen = screenPointer.lock())
 	{
+		lockedScreen->widgetsByIdValid = false;
 		if (lockedScreen->hasFocus(*this))
 		{
 			lockedScreen->psFocus.reset();
@@ -516,12 +523,48 @@ void WIDGET::setScreenPointer(const std::shared_ptr<W_SCREEN> &screen)
 	}
 
 	screenPointer = screen;
+	if (screen != nullptr)
+	{
+		screen->widgetsByIdValid = false;
+	}
 	for (auto const &child: childWidgets)
 	{
 		child->setScreenPointer(screen);
 	}
 }
 
+void WIDGET::invalidateSubtreeBounds()
+{
+	// If a widget is already out of date, so are all its parents.
+	std::shared_ptr<WIDGET> psParent;
+	for (WIDGET *psCurr = this; psCurr != nullptr && !psCurr->subtreeBoundsDirty; psCurr = psParent.get())
+	{
+		psCurr->subtreeBoundsDirty = true;
+		psParent = psCurr->parentWidget.lock();
+	}
+}
+
+WzRect const &WIDGET::subtreeBounds()
+{
+	if (subtreeBoundsDirty)
+	{
+		// Children of clickable forms move down by one pixel while the form is pressed.
+		int shift = type == WIDG_FORM ? 1 : 0;
+		int x0 = 0, y0 = 0, x1 = width(), y1 = height();
+		for (auto const &child: childWidgets)
+		{
+			WzRect const &bounds = child->subtreeBounds();
+			x0 = std::min(x0, bounds.x());
+			y0 = std::min(y0, bounds.y());
+			x1 = std::max(x1, bounds.x() + bounds.width() + shift);
+			y1 = std::max(y1, bounds.y() + bounds.height() + shift);
+		}
+		cachedSubtreeBounds = WzRect(x() + x0, y() + y0, x1 - x0, y1 - y0);
+		subtreeBoundsDirty = false;
+	}
+	return cachedSubtreeBounds;
+}
+
 void WIDGET::widgetLost(WIDGET *widget)
 {
 	if (auto lockedParent = parentWidget.lock())
@@ -724,11 +767,48 @@ std::shared_ptr<WIDGET> widgFormGetFromID(const std::shared_ptr<WIDGET>& widget,
 	return nullptr;
 }
 
+static void widgIndexByID(std::unordered_map<UDWORD, std::weak_ptr<WIDGET>> &index, const std::shared_ptr<WIDGET> &widget)
+{
+	auto inserted = index.emplace(widget->id, widget);
+	if (!inserted.second)
+	{
+		inserted.first->second.reset();  // Used more than once, so leave it to the tree search.
+	}
+	for (auto const &child: widget->children())
+	{
+		widgIndexByID(index, child);
+	}
+}
+
 /* Find a widget in a screen from its ID number */
 WIDGET *widgGetFromID(const std::shared_ptr<W_SCREEN> &psScreen, UDWORD id)
 {
 	ASSERT_OR_RETURN(nullptr, psScreen != nullptr, "Invalid screen pointer");
-	return widgFormGetFromID(psScreen->psForm, id).get();
+	if (!psScreen->widgetsByIdValid && psScreen->psForm != nullptr)
+	{
+		psScreen->widgetsById.clear();
+		widgIndexByID(psScreen->widgetsById, psScreen->psForm);
+		psScreen->widgetsByIdValid = true;
+	}
+	// Widget ids are public and sometimes set after attaching, so only trust the index if the widget still has the id.
+	// Ids used more than once are left out of the index, and searched for in tree order.
+	auto it = psScreen->widgetsById.find(id);
+	bool duplicated = false;
+	if (it != psScreen->widgetsById.end())
+	{
+		std::shared_ptr<WIDGET> psWidget = it->second.lock();
+		if (psWidget != nullptr && psWidget->id == id)
+		{
+			return psWidget.get();
+		}
+		duplicated = psWidget == nullptr;
+	}
+	std::shared_ptr<WIDGET> psWidget = widgFormGetFromID(psScreen->psForm, id);
+	if (!duplicated && (psWidget != nullptr || it != psScreen->widgetsById.end()))
+	{
+		psScreen->widgetsByIdValid = false;  // An id was changed since the index was built.
+	}
+	return psWidget.get();
 }
 
 void widgHide(const std::shared_ptr<W_SCREEN> &psScreen, UDWORD id)
@@ -1261,6 +1341,11 @@ void W_SCREEN::setReturn(const std::shared_ptr<WIDGET> &psWidget)
 
 void WIDGET::displayRecursive(WidgetGraphicsContext const &context)
 {
+	if (context.isClipped() && !context.clipIntersects(subtreeBounds()))
+	{
+		return;  // Nothing in this subtree can be inside the clip rectangle, such as rows scrolled out of a list.
+	}
+
 	if (context.clipContains(geometry())) {
 		if (debugBoundingBoxesOnly)
 		{
@@ -1278,6 +1363,7 @@ void WIDGET::displayRecursive(WidgetGraphicsContext const &context)
 			// Display widget.
 			display(context.getXOffset(), context.getYOffset());
 		}
+		countDisplay();
 	}
 
 	if (type == WIDG_FORM && ((W_FORM *)this)->disableChildren)
@@ -1402,11 +1488,42 @@ bool getWidgetsStatus()
 	return bWidgetsActive;
 }
 
+void WIDGET::countDisplay()
+{
+	++widgetsDisplayed;
+	if (dirty)
+	{
+		++widgetsChanged;
+		dirty = false;
+	}
+}
+
+void widgGetResetDisplayCounts(size_t *pDisplayed, size_t *pChanged)
+{
+	*pDisplayed = widgetsDisplayed;
+	*pChanged = widgetsChanged;
+	widgetsDisplayed = 0;
+	widgetsChanged = 0;
+}
+
 bool WidgetGraphicsContext::clipContains(WzRect const& rect) const
 {
 	return !clipped || clipRect.contains({offset.x + rect.x(), offset.y + rect.y(), rect.width(), rect.height()});
 }
 
+bool WidgetGraphicsContext::clipIntersects(WzRect const& rect) const
+{
+	if (!clipped)
+	{
+		return true;
+	}
+	// Includes the right and bottom edges, since an empty rectangle lying there could still pass clipContains.
+	int left = offset.x + rect.x();
+	int top = offset.y + rect.y();
+	return left < clipRect.x() + clipRect.width() && left + rect.width() >= clipRect.x() &&
+	       top < clipRect.y() + clipRect.height() && top + rect.height() >= clipRect.y();
+}
+
 WidgetGraphicsContext WidgetGraphicsContext::translatedBy(int32_t x, int32_t y) const
 {
 	WidgetGraphicsContext newContext(*this);
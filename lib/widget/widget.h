@@ -362,6 +362,9 @@ WidgetTriggers const &widgRunScreen(const std::shared_ptr<W_SCREEN> &psScreen);
  */
 void widgDisplayScreen(const std::shared_ptr<W_SCREEN> &psScreen);
 
+/** Get the number of widgets drawn since the last call, and how many of them were marked dirty since they were last drawn. */
+void widgGetResetDisplayCounts(size_t *pDisplayed, size_t *pChanged);
+
 
 /** Set the current audio callback function and audio id's. */
 void WidgSetAudio(WIDGET_AUDIOCALLBACK Callback, SWORD HilightID, SWORD ClickedID, SWORD ErrorID);
@@ -35,6 +35,7 @@
 #include "miscimd.h"
 #include "lib/gamelib/gtime.h"
 #include <cmath>
+#include <vector>
 
 #ifndef GLM_ENABLE_EXPERIMENTAL
 	#define GLM_ENABLE_EXPERIMENTAL
@@ -45,202 +46,190 @@
 // -----------------------------------------------------------------------------
 // Shift all this gubbins into a .h file if it makes it into game
 // -----------------------------------------------------------------------------
-/* Roughly one per tile */
+/* Never more than roughly one per tile */
 #define	MAX_ATMOS_PARTICLES		(MAP_MAXWIDTH * MAP_MAXHEIGHT)
-#define	SNOW_SPEED_DRIFT		(40 - rand() % 80)
-#define SNOW_SPEED_FALL			(0 - (rand() % 40 + 80))
-#define	RAIN_SPEED_DRIFT		(rand() % 50)
-#define	RAIN_SPEED_FALL			(0 - ((rand() % 300) + 700))
+#define	SNOW_SPEED_DRIFT		(40 - atmosRandom(80))
+#define SNOW_SPEED_FALL			(0 - (atmosRandom(40) + 80))
+#define	RAIN_SPEED_DRIFT		(atmosRandom(50))
+#define	RAIN_SPEED_FALL			(0 - (atmosRandom(300) + 700))
+#define ATMOS_RANDOM_SEED		0x9E3779B9u
 
 enum AP_TYPE
 {
 	AP_RAIN,
-	AP_SNOW
+	AP_SNOW,
+	AP_MAX
 };
 
-enum AP_STATUS
+/// Active particles, one array per attribute. Particles are kept packed at the front, so a dead
+/// particle is replaced by the last one and the arrays only grow as far as the weather needs.
+struct ATMOS_PARTICLES
 {
-	APS_INACTIVE,
-	APS_ACTIVE
+	std::vector<float>	x, y, z;
+	std::vector<float>	vx, vy, vz;
+	std::vector<uint8_t>	type;
+
+	size_t size() const
+	{
+		return type.size();
+	}
+
+	void add(const Vector3f &pos, const Vector3f &velocity, AP_TYPE apType)
+	{
+		x.push_back(pos.x);
+		y.push_back(pos.y);
+		z.push_back(pos.z);
+		vx.push_back(velocity.x);
+		vy.push_back(velocity.y);
+		vz.push_back(velocity.z);
+		type.push_back(apType);
+	}
+
+	void remove(size_t i)
+	{
+		size_t last = size() - 1;
+		x[i] = x[last];
+		y[i] = y[last];
+		z[i] = z[last];
+		vx[i] = vx[last];
+		vy[i] = vy[last];
+		vz[i] = vz[last];
+		type[i] = type[last];
+		x.pop_back();
+		y.pop_back();
+		z.pop_back();
+		vx.pop_back();
+		vy.pop_back();
+		vz.pop_back();
+		type.pop_back();
+	}
+
+	void clear()
+	{
+		// Swap with empty vectors, so that the memory is actually released.
+		*this = ATMOS_PARTICLES();
+	}
 };
 
-static ATPART	*asAtmosParts = nullptr;
-static UDWORD	freeParticle;
+static ATMOS_PARTICLES	atmosParts;
+static uint32_t		atmosRandomState = ATMOS_RANDOM_SEED;
 static WT_CLASS	weather = WT_NONE;
 
+static const unsigned	particleSize[AP_MAX] = {50, 80};	// Percent, indexed by AP_TYPE
+
+/** Weather particles are purely visual, so they use their own xorshift generator rather than rand() or the synchronised game random. */
+static inline int atmosRandom(uint32_t range)
+{
+	atmosRandomState ^= atmosRandomState << 13;
+	atmosRandomState ^= atmosRandomState >> 17;
+	atmosRandomState ^= atmosRandomState << 5;
+	return atmosRandomState % range;
+}
+
 /* Setup all the particles */
 void atmosInitSystem()
 {
-	if (!asAtmosParts && weather != WT_NONE)
+	if (weather == WT_NONE)
 	{
-		// calloc sets all to APS_INACTIVE initially
-		asAtmosParts = (ATPART *)calloc(MAX_ATMOS_PARTICLES, sizeof(*asAtmosParts));
+		atmosParts.clear();
 	}
-	/* Start at the beginning */
-	freeParticle = 0;
 }
 
-/*	Makes a particle wrap around - if it goes off the grid, then it returns
-	on the other side - provided it's still on world... Which it should be */
-static void testParticleWrap(ATPART *psPart)
+/* Moves all of the particles */
+static void processParticles()
 {
-	/* Gone off left side */
-	if (psPart->position.x < playerPos.p.x - world_coord(visibleTiles.x) / 2)
-	{
-		psPart->position.x += world_coord(visibleTiles.x);
-	}
+	const float timeStep = graphicsTimeAdjustedIncrement(1.f);
+	const size_t count = atmosParts.size();
+	float *x = atmosParts.x.data(), *y = atmosParts.y.data(), *z = atmosParts.z.data();
+	const float *vx = atmosParts.vx.data(), *vy = atmosParts.vy.data(), *vz = atmosParts.vz.data();
 
-	/* Gone off right side */
-	else if (psPart->position.x > (playerPos.p.x + world_coord(visibleTiles.x) / 2))
+	/* Move the particles - frame rate controlled */
+	for (size_t i = 0; i < count; ++i)
 	{
-		psPart->position.x -= world_coord(visibleTiles.x);
+		x[i] += vx[i] * timeStep;
+		y[i] += vy[i] * timeStep;
+		z[i] += vz[i] * timeStep;
 	}
 
-	/* Gone off top */
-	if (psPart->position.z < playerPos.p.z - world_coord(visibleTiles.y) / 2)
+	/* Wrap them around if they've gone off grid... */
+	const float left = playerPos.p.x - world_coord(visibleTiles.x) / 2, right = playerPos.p.x + world_coord(visibleTiles.x) / 2;
+	const float top = playerPos.p.z - world_coord(visibleTiles.y) / 2, bottom = playerPos.p.z + world_coord(visibleTiles.y) / 2;
+	const float width = world_coord(visibleTiles.x), height = world_coord(visibleTiles.y);
+	for (size_t i = 0; i < count; ++i)
 	{
-		psPart->position.z += world_coord(visibleTiles.y);
+		x[i] += x[i] < left ? width : x[i] > right ? -width : 0.f;
+		z[i] += z[i] < top ? height : z[i] > bottom ? -height : 0.f;
 	}
 
-	/* Gone off bottom */
-	else if (psPart->position.z > (playerPos.p.z + world_coord(visibleTiles.y) / 2))
+	/* Kill the ones that have gone off the WORLD or hit the ground */
+	const float worldRight = (mapWidth - 1) * TILE_UNITS, worldBottom = (mapHeight - 1) * TILE_UNITS;
+	for (size_t i = 0; i < atmosParts.size();)
 	{
-		psPart->position.z -= world_coord(visibleTiles.y);
-	}
-}
+		Vector3f position(atmosParts.x[i], atmosParts.y[i], atmosParts.z[i]);
+		AP_TYPE type = (AP_TYPE)atmosParts.type[i];
 
-/* Moves one of the particles */
-static void processParticle(ATPART *psPart)
-{
-	SDWORD	groundHeight;
-	Vector3i pos;
-	UDWORD	x, y;
-	MAPTILE	*psTile;
-
-	/* Only move if the game isn't paused */
-	if (!gamePaused())
-	{
-		/* Move the particle - frame rate controlled */
-		psPart->position.x += graphicsTimeAdjustedIncrement(psPart->velocity.x);
-		psPart->position.y += graphicsTimeAdjustedIncrement(psPart->velocity.y);
-		psPart->position.z += graphicsTimeAdjustedIncrement(psPart->velocity.z);
-
-		/* Wrap it around if it's gone off grid... */
-		testParticleWrap(psPart);
-
-		/* If it's gone off the WORLD... */
-		if (psPart->position.x < 0 || psPart->position.z < 0 ||
-		    psPart->position.x > ((mapWidth - 1)*TILE_UNITS) ||
-		    psPart->position.z > ((mapHeight - 1)*TILE_UNITS))
+		if (position.x < 0 || position.z < 0 || position.x > worldRight || position.z > worldBottom)
 		{
-			/* The kill it */
-			psPart->status = APS_INACTIVE;
-			return;
+			atmosParts.remove(i);
+			continue;
 		}
 
 		/* What height is the ground under it? Only do if low enough...*/
-		if (psPart->position.y < 255 * ELEVATION_SCALE)
+		if (position.y < 255 * ELEVATION_SCALE)
 		{
 			/* Get ground height */
-			groundHeight = map_Height(psPart->position.x, psPart->position.z);
+			SDWORD groundHeight = map_Height(position.x, position.z);
 
 			/* Are we below ground? */
-			if ((int)psPart->position.y < groundHeight
-			    || psPart->position.y < 0.f)
+			if ((int)position.y < groundHeight || position.y < 0.f)
 			{
-				/* Kill it and return */
-				psPart->status = APS_INACTIVE;
-				if (psPart->type == AP_RAIN)
+				/* Kill it */
+				atmosParts.remove(i);
+				if (type == AP_RAIN)
 				{
-					x = map_coord(psPart->position.x);
-					y = map_coord(psPart->position.z);
-					psTile = mapTile(x, y);
+					MAPTILE *psTile = mapTile(map_coord(position.x), map_coord(position.z));
 					if (terrainType(psTile) == TER_WATER && TEST_TILE_VISIBLE(selectedPlayer, psTile))
 					{
-						pos.x = psPart->position.x;
-						pos.z = psPart->position.z;
-						pos.y = groundHeight;
+						Vector3i pos(position.x, groundHeight, position.z);
 						effectSetSize(60);
 						addEffect(&pos, EFFECT_EXPLOSION, EXPLOSION_TYPE_SPECIFIED, true, getImdFromIndex(MI_SPLASH), 0);
 					}
 				}
-				return;
+				continue;
 			}
 		}
-		if (psPart->type == AP_SNOW)
+		if (type == AP_SNOW)
 		{
-			if (rand() % 30 == 1)
+			if (atmosRandom(30) == 1)
 			{
-				psPart->velocity.z = (float)SNOW_SPEED_DRIFT;
+				atmosParts.vz[i] = (float)SNOW_SPEED_DRIFT;
 			}
-			if (rand() % 30 == 1)
+			if (atmosRandom(30) == 1)
 			{
-				psPart->velocity.x = (float)SNOW_SPEED_DRIFT;
+				atmosParts.vx[i] = (float)SNOW_SPEED_DRIFT;
 			}
 		}
+		++i;
 	}
 }
 
 /* Adds a particle to the system if it can */
 static void atmosAddParticle(const Vector3f &pos, AP_TYPE type)
 {
-	UDWORD	activeCount;
-	UDWORD	i;
-
-	for (i = freeParticle, activeCount = 0; asAtmosParts[i].status == APS_ACTIVE && activeCount < MAX_ATMOS_PARTICLES; i++)
+	/* All of the particles active!?!? */
+	if (atmosParts.size() >= MAX_ATMOS_PARTICLES - 1)
 	{
-		activeCount++;
-		/* Check for wrap around */
-		if (i >= (MAX_ATMOS_PARTICLES - 1))
-		{
-			/* Go back to the first one */
-			i = 0;
-		}
-	}
-
-	/* Check the list isn't just full of essential effects */
-	if (activeCount >= MAX_ATMOS_PARTICLES - 1)
-	{
-		/* All of the particles active!?!? */
 		return;
 	}
-	else
-	{
-		freeParticle = i;
-	}
-
-	/* Record it's type */
-	asAtmosParts[freeParticle].type = (UBYTE)type;
-
-	/* Make it active */
-	asAtmosParts[freeParticle].status = APS_ACTIVE;
-
-	/* Setup the imd */
-	switch (type)
-	{
-	case AP_SNOW:
-		asAtmosParts[freeParticle].imd = getImdFromIndex(MI_SNOW);
-		asAtmosParts[freeParticle].size = 80;
-		break;
-	case AP_RAIN:
-		asAtmosParts[freeParticle].imd = getImdFromIndex(MI_RAIN);
-		asAtmosParts[freeParticle].size = 50;
-		break;
-	default:
-		break;
-	}
-
-	/* Setup position */
-	asAtmosParts[freeParticle].position = pos;
 
 	/* Setup its velocity */
 	if (type == AP_RAIN)
 	{
-		asAtmosParts[freeParticle].velocity = Vector3f(RAIN_SPEED_DRIFT, RAIN_SPEED_FALL, RAIN_SPEED_DRIFT);
+		atmosParts.add(pos, Vector3f(RAIN_SPEED_DRIFT, RAIN_SPEED_FALL, RAIN_SPEED_DRIFT), type);
 	}
 	else
 	{
-		asAtmosParts[freeParticle].velocity = Vector3f(SNOW_SPEED_DRIFT, SNOW_SPEED_FALL, SNOW_SPEED_DRIFT);
+		atmosParts.add(pos, Vector3f(SNOW_SPEED_DRIFT, SNOW_SPEED_FALL, SNOW_SPEED_DRIFT), type);
 	}
 }
 
@@ -254,14 +243,7 @@ void atmosUpdateSystem()
 	// we don't want to do any of this while paused.
 	if (!gamePaused() && weather != WT_NONE)
 	{
-		for (i = 0; i < MAX_ATMOS_PARTICLES; i++)
-		{
-			/* See if it's active */
-			if (asAtmosParts[i].status == APS_ACTIVE)
-			{
-				processParticle(&asAtmosParts[i]);
-			}
-		}
+		processParticles();
 
 		// The original code added a fixed number of particles per tick. To take into account game speed
 		// we have to accumulate a fractional number of particles to add them at a slower or faster rate.
@@ -281,8 +263,8 @@ void atmosUpdateSystem()
 		{
 			pos.x = playerPos.p.x;
 			pos.z = playerPos.p.z;
-			pos.x += world_coord(rand() % visibleTiles.x - visibleTiles.x / 2);
-			pos.z += world_coord(rand() % visibleTiles.x - visibleTiles.y / 2);
+			pos.x += world_coord(atmosRandom(visibleTiles.x) - visibleTiles.x / 2);
+			pos.z += world_coord(atmosRandom(visibleTiles.x) - visibleTiles.y / 2);
 			pos.y = 1000;
 
 			/* If we've got one on the grid */
@@ -309,46 +291,37 @@ void atmosUpdateSystem()
 
 void atmosDrawParticles(const glm::mat4 &viewMatrix)
 {
-	UDWORD	i;
-
-	if (weather == WT_NONE)
+	if (weather == WT_NONE || atmosParts.size() == 0)
 	{
 		return;
 	}
 
-	/* Traverse the list */
-	for (i = 0; i < MAX_ATMOS_PARTICLES; i++)
+	/* Make them face camera and scale them. This part is the same for every particle of a type, so
+	   only the translation needs working out per particle. */
+	iIMDShape *imd[AP_MAX] = {getImdFromIndex(MI_RAIN), getImdFromIndex(MI_SNOW)};
+	glm::mat4 viewBillboard[AP_MAX];
+	for (int type = 0; type < AP_MAX; ++type)
 	{
-		/* Don't bother unless it's active */
-		if (asAtmosParts[i].status == APS_ACTIVE)
+		viewBillboard[type] = viewMatrix *
+			glm::rotate(UNDEG(-playerPos.r.y), glm::vec3(0.f, 1.f, 0.f)) *
+			glm::rotate(UNDEG(-playerPos.r.x), glm::vec3(0.f, 1.f, 0.f)) *
+			glm::scale(glm::vec3(particleSize[type] / 100.f));
+	}
+
+	for (size_t i = 0; i < atmosParts.size(); ++i)
+	{
+		/* Is it visible on the screen? */
+		if (!clipXYZ(atmosParts.x[i], atmosParts.z[i], atmosParts.y[i], viewMatrix))
 		{
-			/* Is it visible on the screen? */
-			if (clipXYZ(asAtmosParts[i].position.x, asAtmosParts[i].position.z, asAtmosParts[i].position.y, viewMatrix))
-			{
-				renderParticle(&asAtmosParts[i], viewMatrix);
-			}
+			continue;
 		}
+		const Vector3i dv(atmosParts.x[i] - playerPos.p.x, atmosParts.y[i], -(atmosParts.z[i] - playerPos.p.z));
+		glm::mat4 modelView = viewBillboard[atmosParts.type[i]];
+		modelView[3] = viewMatrix * glm::vec4(glm::vec3(dv), 1.f);
+		pie_Draw3DShape(imd[atmosParts.type[i]], 0, 0, WZCOL_WHITE, 0, 0, modelView);
 	}
 }
 
-void renderParticle(ATPART *psPart, const glm::mat4 &viewMatrix)
-{
-	Vector3i dv;
-
-	/* Transform it */
-	dv.x = psPart->position.x - playerPos.p.x;
-	dv.y = psPart->position.y;
-	dv.z = -(psPart->position.z - playerPos.p.z);
-	/* Make it face camera */
-	/* Scale it... */
-	const glm::mat4 modelMatrix = glm::translate(glm::vec3(dv)) *
-		glm::rotate(UNDEG(-playerPos.r.y), glm::vec3(0.f, 1.f, 0.f)) *
-		glm::rotate(UNDEG(-playerPos.r.x), glm::vec3(0.f, 1.f, 0.f)) *
-		glm::scale(glm::vec3(psPart->size / 100.f));
-	pie_Draw3DShape(psPart->imd, 0, 0, WZCOL_WHITE, 0, 0, viewMatrix * modelMatrix);
-	/* Draw it... */
-}
-
 void atmosSetWeatherType(WT_CLASS type)
 {
 	if (type != weather)
@@ -356,10 +329,9 @@ void atmosSetWeatherType(WT_CLASS type)
 		weather = type;
 		atmosInitSystem();
 	}
-	if (type == WT_NONE && asAtmosParts)
+	if (type == WT_NONE)
 	{
-		free(asAtmosParts);
-		asAtmosParts = nullptr;
+		atmosParts.clear();
 	}
 }
 
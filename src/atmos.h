@@ -24,16 +24,6 @@
 #include "lib/framework/vector.h"
 #include "lib/ivis_opengl/ivisdef.h"
 
-struct ATPART
-{
-	UBYTE		status;
-	UBYTE		type;
-	UDWORD		size;
-	Vector3f	position;
-	Vector3f	velocity;
-	iIMDShape	*imd;
-};
-
 enum WT_CLASS
 {
 	WT_RAINING,
@@ -43,7 +33,6 @@ enum WT_CLASS
 
 void atmosInitSystem();
 void atmosUpdateSystem();
-void renderParticle(ATPART *psPart, const glm::mat4 &viewMatrix);
 void atmosDrawParticles(const glm::mat4 &viewMatrix);
 void atmosSetWeatherType(WT_CLASS type);
 WT_CLASS atmosGetWeatherType();
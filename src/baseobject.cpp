@@ -30,6 +30,8 @@
 #include "intdisplay.h"
 #include "map.h"
 
+static uint32_t freeGeneration = 0;
+
 
 static inline uint16_t interpolateAngle(uint16_t v1, uint16_t v2, uint32_t t1, uint32_t t2, uint32_t t)
 {
@@ -115,6 +117,7 @@ BASE_OBJECT::BASE_OBJECT(OBJECT_TYPE type, uint32_t id, unsigned player)
 BASE_OBJECT::~BASE_OBJECT()
 {
 	visRemoveVisibility(this);
+	++freeGeneration;
 
 #ifdef DEBUG
 	psNext = this;                                                       // Hopefully this will trigger an infinite loop       if someone uses the freed object.
@@ -122,6 +125,11 @@ BASE_OBJECT::~BASE_OBJECT()
 #endif //DEBUG
 }
 
+uint32_t baseObjectFreeGeneration()
+{
+	return freeGeneration;
+}
+
 void checkObject(const SIMPLE_OBJECT *psObject, const char *const location_description, const char *function, const int recurse)
 {
 	if (recurse < 0)
@@ -58,6 +58,9 @@ Spacetime interpolateObjectSpacetime(const SIMPLE_OBJECT *obj, uint32_t t);
 
 void checkObject(const SIMPLE_OBJECT *psObject, const char *const location_description, const char *function, const int recurse);
 
+/// Changes whenever a BASE_OBJECT is freed. A pointer to an object stays valid for as long as this doesn't change.
+uint32_t baseObjectFreeGeneration();
+
 /* assert if object is bad */
 #define CHECK_OBJECT(object) checkObject((object), AT_MACRO, __FUNCTION__, max_check_object_recursion)
 
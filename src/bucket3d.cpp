@@ -24,19 +24,18 @@
  */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/radixsort.h"
 #include "lib/framework/vector.h"
 #include "lib/ivis_opengl/piematrix.h"
 #include "lib/ivis_opengl/pieclip.h"
+#include "lib/ivis_opengl/ivisdef.h"
 
-#include "atmos.h"
 #include "bucket3d.h"
 #include "component.h"
 #include "display3d.h"
 #include "effects.h"
 #include "miscimd.h"
 
-#include <algorithm>
-
 #define CLIP_LEFT	((SDWORD)0)
 #define CLIP_RIGHT	((SDWORD)pie_GetVideoBufferWidth())
 #define CLIP_TOP	((SDWORD)0)
@@ -47,17 +46,13 @@
 
 struct BUCKET_TAG
 {
-	bool operator <(BUCKET_TAG const &b) const
-	{
-		return actualZ > b.actualZ;    // Sort in reverse z order.
-	}
-
+	uint64_t        key;        ///< Sort key, reverse z order in the high bits, then objectType.
 	RENDER_TYPE     objectType; //type of object held
 	void           *pObject;    //pointer to the object
-	int32_t         actualZ;
 };
 
 static std::vector<BUCKET_TAG> bucketArray;
+static std::vector<BUCKET_TAG> bucketScratch;
 
 static SDWORD bucketCalculateZ(RENDER_TYPE objectType, void *pObject, const glm::mat4 &viewMatrix)
 {
@@ -73,29 +68,6 @@ static SDWORD bucketCalculateZ(RENDER_TYPE objectType, void *pObject, const glm:
 
 	switch (objectType)
 	{
-	case RENDER_PARTICLE:
-		position.x = ((ATPART *)pObject)->position.x;
-		position.y = ((ATPART *)pObject)->position.y;
-		position.z = ((ATPART *)pObject)->position.z;
-
-		position.x = position.x - playerPos.p.x;
-		position.z = -(position.z - playerPos.p.z);
-
-		/* 16 below is HACK!!! */
-		z = pie_RotateProject(&position, viewMatrix, &pixel) - 16;
-		if (z > 0)
-		{
-			//particle use the image radius
-			radius = ((ATPART *)pObject)->imd->radius;
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
-		}
-		break;
 	case RENDER_PROJECTILE:
 		if (((PROJECTILE *)pObject)->psWStats->weaponSubClass == WSC_FLAME ||
 		    ((PROJECTILE *)pObject)->psWStats->weaponSubClass == WSC_COMMAND ||
@@ -365,18 +337,15 @@ void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject, const glm::mat4
 		                         factoryType][((FLAG_POSITION *)pObject)->factoryInc];
 		z = INT32_MAX - pie->texpage;
 		break;
-	case RENDER_PARTICLE:
-		z = 0;
-		break;
 	default:
 		// Use calculated Z
 		break;
 	}
 
 	//put the object data into the tag
+	newTag.key = (uint64_t)(uint32_t)(INT32_MAX - z) << 32 | (uint64_t)objectType;
 	newTag.objectType = objectType;
 	newTag.pObject = pObject;
-	newTag.actualZ = z;
 
 	//add tag to bucketArray
 	bucketArray.push_back(newTag);
@@ -385,15 +354,13 @@ void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject, const glm::mat4
 /* render Objects in list */
 void bucketRenderCurrentList(const glm::mat4 &viewMatrix)
 {
-	std::sort(bucketArray.begin(), bucketArray.end());
+	// Stable, so objects at the same z keep the order they were added in.
+	radixSortByKey(bucketArray, bucketScratch);
 
 	for (std::vector<BUCKET_TAG>::const_iterator thisTag = bucketArray.begin(); thisTag != bucketArray.end(); ++thisTag)
 	{
 		switch (thisTag->objectType)
 		{
-		case RENDER_PARTICLE:
-			renderParticle((ATPART *)thisTag->pObject, viewMatrix);
-			break;
 		case RENDER_EFFECT:
 			renderEffect((EFFECT *)thisTag->pObject, viewMatrix);
 			break;
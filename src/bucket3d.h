@@ -29,8 +29,7 @@ enum RENDER_TYPE
 	RENDER_PROXMSG,
 	RENDER_PROJECTILE,
 	RENDER_EFFECT,
-	RENDER_DELIVPOINT,
-	RENDER_PARTICLE
+	RENDER_DELIVPOINT
 };
 
 //function prototypes
@@ -28,6 +28,7 @@
 #include "lib/ivis_opengl/screen.h"
 #include "lib/netplay/netplay.h"
 #include "lib/ivis_opengl/pieclip.h"
+#include "lib/ivis_opengl/gfx_api_null.h"
 
 #include "levels.h"
 #include "clparse.h"
@@ -82,6 +83,7 @@ static std::string wz_saveandquit;
 static std::string wz_test;
 static std::string wz_autoratingUrl;
 static bool wz_cli_headless = false;
+static bool wz_cli_gfxstats = false;
 
 #if defined(WZ_OS_WIN)
 
@@ -323,6 +325,7 @@ typedef enum
 	CLI_AUTOHOST,
 	CLI_AUTORATING,
 	CLI_AUTOHEADLESS,
+	CLI_GFXSTATS,
 #if defined(WZ_OS_WIN)
 	CLI_WIN_ENABLE_CONSOLE,
 #endif
@@ -377,6 +380,7 @@ static const struct poptOption *getOptionsTable()
 		},
 		{ "autogame", POPT_ARG_NONE, CLI_AUTOGAME,   N_("Run games automatically for testing"), nullptr },
 		{ "headless", POPT_ARG_NONE, CLI_AUTOHEADLESS,   N_("Headless mode (only supported when also specifying --autogame, --autohost, --skirmish)"), nullptr },
+		{ "gfxstats", POPT_ARG_STRING, CLI_GFXSTATS,   N_("Draw frames in headless mode, and record the draw statistics of each frame to file"), N_("file") },
 		{ "saveandquit", POPT_ARG_STRING, CLI_SAVEANDQUIT, N_("Immediately save game and quit"), N_("save name") },
 		{ "skirmish", POPT_ARG_STRING, CLI_SKIRMISH,   N_("Start skirmish game with given settings file"), N_("test") },
 		{ "continue", POPT_ARG_NONE, CLI_CONTINUE,   N_("Continue the last saved game"), nullptr },
@@ -839,6 +843,16 @@ bool ParseCommandLine(int argc, const char * const *argv)
 			setHeadlessGameMode(true);
 			break;
 
+		case CLI_GFXSTATS:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr)
+			{
+				qFatal("Missing gfxstats filename?");
+			}
+			wz_cli_gfxstats = true;
+			gfx_api::setNullBackendStatsFile(token);
+			break;
+
 		case CLI_GAMEPORT:
 			token = poptGetOptArg(poptCon);
 			if (token == nullptr)
@@ -860,6 +874,11 @@ bool autogame_enabled()
 	return wz_autogame;
 }
 
+bool gfxstats_enabled()
+{
+	return wz_cli_gfxstats;
+}
+
 const std::string &saveandquit_enabled()
 {
 	return wz_saveandquit;
@@ -55,6 +55,7 @@
 #include "console.h"
 #include "order.h"
 #include "wrappers.h"
+#include "clparse.h"
 #include "power.h"
 #include "map.h"
 #include "keymap.h"
@@ -1167,7 +1168,7 @@ bool CheckScrollLimits()
 /* Do the 3D display */
 void displayWorld()
 {
-	if (headlessGameMode())
+	if (headlessGameMode() && !gfxstats_enabled())
 	{
 		return;
 	}
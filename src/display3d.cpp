@@ -94,6 +94,7 @@ static void displayProximityMsgs(const glm::mat4& viewMatrix);
 static void displayDynamicObjects(const glm::mat4 &viewMatrix);
 static void displayStaticObjects(const glm::mat4 &viewMatrix);
 static void displayFeatures(const glm::mat4 &viewMatrix);
+static void displayIndexUpdate();
 static UDWORD	getTargettingGfx();
 static void	drawDroidGroupNumber(DROID *psDroid);
 static void	trackHeight(int desiredHeight);
@@ -1200,6 +1201,7 @@ static void drawTiles(iView *player)
 	/* ---------------------------------------------------------------- */
 	/* Now display all the static objects                               */
 	/* ---------------------------------------------------------------- */
+	displayIndexUpdate();
 	displayStaticObjects(viewMatrix); // may be bucket render implemented
 	displayFeatures(viewMatrix);
 	displayDynamicObjects(viewMatrix); // may be bucket render implemented
@@ -1630,34 +1632,178 @@ void	renderProjectile(PROJECTILE *psCurr, const glm::mat4 &viewMatrix)
 }
 
 /// Draw the buildings
-static void displayStaticObjects(const glm::mat4 &viewMatrix)
+/// Objects that may be drawn, by blocks of DISPLAY_BLOCK_TILES × DISPLAY_BLOCK_TILES tiles, so that each frame only
+/// visits the objects near the camera instead of every object on the map. Objects only move, appear and disappear
+/// during game updates, so the index is only rebuilt when the game time or the object lists changed.
+#define DISPLAY_BLOCK_TILES 8
+
+struct DISPLAY_INDEX_ENTRY
 {
-	// to solve the flickering edges of baseplates
-//	pie_SetDepthOffset(-1.0f);
+	uint32_t order;  ///< Position in the object lists, so that objects are drawn in the same order as before.
+	BASE_OBJECT *psObj;
+
+	bool operator <(const DISPLAY_INDEX_ENTRY &b) const
+	{
+		return order < b.order;
+	}
+};
+
+struct DISPLAY_INDEX
+{
+	int margin = 0;  ///< World units around an object's position that it may be drawn for.
+	std::vector<std::vector<DISPLAY_INDEX_ENTRY>> blocks;
+};
+
+static DISPLAY_INDEX displayIndexStructures, displayIndexFeatures, displayIndexDroids;
+static int displayIndexBlocksX = 0, displayIndexBlocksY = 0;
+static size_t displayObjectsVisited = 0;
+
+static void displayIndexClear(DISPLAY_INDEX &index)
+{
+	index.margin = TILE_UNITS;
+	index.blocks.resize(displayIndexBlocksX * displayIndexBlocksY);
+	for (auto &block : index.blocks)
+	{
+		block.clear();
+	}
+}
+
+static void displayIndexInsert(DISPLAY_INDEX &index, BASE_OBJECT *psObj, uint32_t order)
+{
+	int blockX = clip(map_coord(psObj->pos.x) / DISPLAY_BLOCK_TILES, 0, displayIndexBlocksX - 1);
+	int blockY = clip(map_coord(psObj->pos.y) / DISPLAY_BLOCK_TILES, 0, displayIndexBlocksY - 1);
+	index.blocks[blockY * displayIndexBlocksX + blockX].push_back({order, psObj});
+}
+
+/// Called once per frame before drawing objects. Rebuilds the display index if objects may have changed since it was built.
+static void displayIndexUpdate()
+{
+	static uint32_t lastGameTime = 0, lastFreeGeneration = 0, lastListGeneration = 0;
+	static std::vector<BASE_OBJECT *> lastListHeads;
+	static int lastMapWidth = -1, lastMapHeight = -1;
 
-	/* Go through all the players */
-	for (unsigned aPlayer = 0; aPlayer <= MAX_PLAYERS; ++aPlayer)
+	// The campaign swaps whole object lists in and out, which only shows in the list heads.
+	std::vector<BASE_OBJECT *> listHeads;
+	listHeads.reserve(2 * MAX_PLAYERS + 2);
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
 	{
-		BASE_OBJECT *list = aPlayer < MAX_PLAYERS ? apsStructLists[aPlayer] : psDestroyedObj;
+		listHeads.push_back(apsDroidLists[player]);
+		listHeads.push_back(apsStructLists[player]);
+	}
+	listHeads.push_back(apsFeatureLists[0]);
+	listHeads.push_back(psDestroyedObj);
 
-		/* Now go all buildings for that player */
-		for (; list != nullptr; list = list->psNext)
+	if (lastGameTime == gameTime && lastFreeGeneration == baseObjectFreeGeneration() && lastListGeneration == objmemListGeneration()
+	    && lastListHeads == listHeads && lastMapWidth == (int)mapWidth && lastMapHeight == (int)mapHeight)
+	{
+		return;
+	}
+	lastGameTime = gameTime;
+	lastFreeGeneration = baseObjectFreeGeneration();
+	lastListGeneration = objmemListGeneration();
+	lastListHeads = std::move(listHeads);
+	lastMapWidth = mapWidth;
+	lastMapHeight = mapHeight;
+
+	displayIndexBlocksX = std::max<int>((mapWidth + DISPLAY_BLOCK_TILES - 1) / DISPLAY_BLOCK_TILES, 1);
+	displayIndexBlocksY = std::max<int>((mapHeight + DISPLAY_BLOCK_TILES - 1) / DISPLAY_BLOCK_TILES, 1);
+	displayIndexClear(displayIndexStructures);
+	displayIndexClear(displayIndexFeatures);
+	displayIndexClear(displayIndexDroids);
+
+	// Same lists, in the same order, as drawing used to walk every frame.
+	uint32_t order = 0;
+	for (unsigned player = 0; player <= MAX_PLAYERS; ++player)
+	{
+		for (BASE_OBJECT *psObj = player < MAX_PLAYERS ? apsStructLists[player] : psDestroyedObj; psObj != nullptr; psObj = psObj->psNext)
 		{
-			/* Worth rendering the structure? */
-			if (list->type != OBJ_STRUCTURE || (list->died != 0 && list->died < graphicsTime))
+			if (psObj->type == OBJ_STRUCTURE)
 			{
-				continue;
+				// clipStructureOnScreen() looks at every tile under the structure, plus a border of 2 tiles.
+				StructureBounds b = getStructureBounds(castStructure(psObj));
+				displayIndexStructures.margin = std::max(displayIndexStructures.margin, world_coord(std::max(b.size.x, b.size.y) + 2));
+				displayIndexInsert(displayIndexStructures, psObj, order++);
 			}
-			STRUCTURE *psStructure = castStructure(list);
-
-			if (!clipStructureOnScreen(psStructure))
+		}
+	}
+	for (unsigned player = 0; player <= 1; ++player)
+	{
+		for (BASE_OBJECT *psObj = player < 1 ? apsFeatureLists[player] : psDestroyedObj; psObj != nullptr; psObj = psObj->psNext)
+		{
+			if (psObj->type == OBJ_FEATURE)
 			{
-				continue;
+				displayIndexInsert(displayIndexFeatures, psObj, order++);
 			}
+		}
+	}
+	for (unsigned player = 0; player <= MAX_PLAYERS; ++player)
+	{
+		for (BASE_OBJECT *psObj = player < MAX_PLAYERS ? apsDroidLists[player] : psDestroyedObj; psObj != nullptr; psObj = psObj->psNext)
+		{
+			if (psObj->type == OBJ_DROID)
+			{
+				displayIndexInsert(displayIndexDroids, psObj, order++);
+			}
+		}
+	}
+}
 
-			renderStructure(psStructure, viewMatrix);
+/// The objects of the index that may be on screen, in list order.
+static const std::vector<DISPLAY_INDEX_ENTRY> &displayIndexQuery(const DISPLAY_INDEX &index)
+{
+	static std::vector<DISPLAY_INDEX_ENTRY> results;  // static to avoid allocations.
+	results.clear();
+
+	// The area that quickClipXYToMaximumTilesFromCurrentPosition() and clipXY() accept, plus the margin.
+	int rangeX = world_coord(visibleTiles.x / 2 + 2) + index.margin;
+	int rangeY = world_coord(visibleTiles.y / 2 + 2) + index.margin;
+	int x0 = clip(map_coord(playerPos.p.x - rangeX) / DISPLAY_BLOCK_TILES, 0, displayIndexBlocksX - 1);
+	int x1 = clip(map_coord(playerPos.p.x + rangeX) / DISPLAY_BLOCK_TILES, 0, displayIndexBlocksX - 1);
+	int y0 = clip(map_coord(playerPos.p.z - rangeY) / DISPLAY_BLOCK_TILES, 0, displayIndexBlocksY - 1);
+	int y1 = clip(map_coord(playerPos.p.z + rangeY) / DISPLAY_BLOCK_TILES, 0, displayIndexBlocksY - 1);
+	for (int y = y0; y <= y1; ++y)
+	{
+		for (int x = x0; x <= x1; ++x)
+		{
+			const auto &block = index.blocks[y * displayIndexBlocksX + x];
+			results.insert(results.end(), block.begin(), block.end());
 		}
 	}
+	std::sort(results.begin(), results.end());
+	displayObjectsVisited += results.size();
+	return results;
+}
+
+size_t displayGetResetObjectsVisited()
+{
+	size_t visited = displayObjectsVisited;
+	displayObjectsVisited = 0;
+	return visited;
+}
+
+static void displayStaticObjects(const glm::mat4 &viewMatrix)
+{
+	// to solve the flickering edges of baseplates
+//	pie_SetDepthOffset(-1.0f);
+
+	for (const DISPLAY_INDEX_ENTRY &entry : displayIndexQuery(displayIndexStructures))
+	{
+		BASE_OBJECT *list = entry.psObj;
+
+		/* Worth rendering the structure? */
+		if (list->died != 0 && list->died < graphicsTime)
+		{
+			continue;
+		}
+		STRUCTURE *psStructure = castStructure(list);
+
+		if (!clipStructureOnScreen(psStructure))
+		{
+			continue;
+		}
+
+		renderStructure(psStructure, viewMatrix);
+	}
 //	pie_SetDepthOffset(0.0f);
 }
 
@@ -1891,21 +2037,15 @@ static void displayDelivPoints(const glm::mat4& viewMatrix)
 /// Draw the features
 static void displayFeatures(const glm::mat4 &viewMatrix)
 {
-	// player can only be 0 for the features.
-	for (unsigned player = 0; player <= 1; ++player)
+	for (const DISPLAY_INDEX_ENTRY &entry : displayIndexQuery(displayIndexFeatures))
 	{
-		BASE_OBJECT *list = player < 1 ? apsFeatureLists[player] : psDestroyedObj;
+		BASE_OBJECT *list = entry.psObj;
 
-		/* Go through all the features */
-		for (; list != nullptr; list = list->psNext)
+		if ((list->died == 0 || list->died > graphicsTime)
+		    && clipXY(list->pos.x, list->pos.y))
 		{
-			if (list->type == OBJ_FEATURE
-			    && (list->died == 0 || list->died > graphicsTime)
-			    && clipXY(list->pos.x, list->pos.y))
-			{
-				FEATURE *psFeature = castFeature(list);
-				renderFeature(psFeature, viewMatrix);
-			}
+			FEATURE *psFeature = castFeature(list);
+			renderFeature(psFeature, viewMatrix);
 		}
 	}
 }
@@ -1946,25 +2086,20 @@ static void displayProximityMsgs(const glm::mat4& viewMatrix)
 /// Draw the droids
 static void displayDynamicObjects(const glm::mat4 &viewMatrix)
 {
-	/* Need to go through all the droid lists */
-	for (unsigned player = 0; player <= MAX_PLAYERS; ++player)
+	for (const DISPLAY_INDEX_ENTRY &entry : displayIndexQuery(displayIndexDroids))
 	{
-		BASE_OBJECT *list = player < MAX_PLAYERS ? apsDroidLists[player] : psDestroyedObj;
-
-		for (; list != nullptr; list = list->psNext)
+		BASE_OBJECT *list = entry.psObj;
+		DROID *psDroid = castDroid(list);
+		if ((list->died != 0 && list->died < graphicsTime)
+		    || !quickClipXYToMaximumTilesFromCurrentPosition(list->pos.x, list->pos.y))
 		{
-			DROID *psDroid = castDroid(list);
-			if (!psDroid || (list->died != 0 && list->died < graphicsTime)
-			    || !quickClipXYToMaximumTilesFromCurrentPosition(list->pos.x, list->pos.y))
-			{
-				continue;
-			}
+			continue;
+		}
 
-			/* No point in adding it if you can't see it? */
-			if (psDroid->visible[selectedPlayer])
-			{
-				displayComponentObject(psDroid, viewMatrix);
-			}
+		/* No point in adding it if you can't see it? */
+		if (psDroid->visible[selectedPlayer])
+		{
+			displayComponentObject(psDroid, viewMatrix);
 		}
 	}
 }
@@ -1345,6 +1345,39 @@ static unsigned calcUpgradeSum(const DROID *psDroid, int player, F func, G propu
 	return calcUpgradeSum(psDroid->asBits, f.numWeaps, f.asWeaps, player, func, propulsionFunc);
 }
 
+/// Bumped by droidUpgradesChanged().
+static uint32_t droidUpgradeEpoch[MAX_PLAYERS];
+
+template <typename T>
+static uint32_t calcBody(T *obj, int player);
+template <typename T>
+static uint32_t calcBuild(T *obj);
+template <typename T>
+static uint32_t calcPower(const T *obj);
+
+/// The cached sums over the droid's components, worked out again if its components or its player's upgrades changed.
+static const DROID_DERIVED_STATS &droidDerivedStats(const DROID *psDroid)
+{
+	DROID_DERIVED_STATS &stats = psDroid->derivedStats;
+	if (!stats.valid || stats.upgradeEpoch != droidUpgradeEpoch[psDroid->player] || stats.player != psDroid->player)
+	{
+		stats.power = calcPower(psDroid);
+		stats.points = calcBuild(psDroid);
+		stats.baseBody = calcBody(psDroid, psDroid->player);
+		stats.player = psDroid->player;
+		stats.upgradeEpoch = droidUpgradeEpoch[psDroid->player];
+		stats.valid = true;
+	}
+#ifdef DEBUG
+	else
+	{
+		ASSERT(stats.power == calcPower(psDroid) && stats.points == calcBuild(psDroid) && stats.baseBody == calcBody(psDroid, psDroid->player),
+		       "Stale derived stats for droid %u, missing droidComponentsChanged() or droidUpgradesChanged() call", psDroid->id);
+	}
+#endif
+	return stats;
+}
+
 /* Calculate the weight of a droid from it's template */
 UDWORD calcDroidWeight(const DROID_TEMPLATE *psTemplate)
 {
@@ -1391,7 +1424,7 @@ UDWORD calcTemplateBody(const DROID_TEMPLATE *psTemplate, UBYTE player)
 // Calculate the base body points of a droid with upgrades
 static UDWORD calcDroidBaseBody(DROID *psDroid)
 {
-	return calcBody(psDroid, psDroid->player);
+	return droidDerivedStats(psDroid).baseBody;
 }
 
 
@@ -1461,7 +1494,7 @@ UDWORD calcTemplateBuild(const DROID_TEMPLATE *psTemplate)
 
 UDWORD calcDroidPoints(DROID *psDroid)
 {
-	return calcBuild(psDroid);
+	return droidDerivedStats(psDroid).points;
 }
 
 template <typename T>
@@ -1486,7 +1519,19 @@ UDWORD calcTemplatePower(const DROID_TEMPLATE *psTemplate)
 /* Calculate the power points required to build/maintain a droid */
 UDWORD calcDroidPower(const DROID *psDroid)
 {
-	return calcPower(psDroid);
+	ASSERT_NOT_NULLPTR_OR_RETURN(0, psDroid);
+	return droidDerivedStats(psDroid).power;
+}
+
+void droidComponentsChanged(DROID *psDroid)
+{
+	psDroid->derivedStats.valid = false;
+}
+
+void droidUpgradesChanged(int player)
+{
+	ASSERT_OR_RETURN(, player >= 0 && player < MAX_PLAYERS, "Bad player %d", player);
+	++droidUpgradeEpoch[player];
 }
 
 //Builds an instance of a Droid - the x/y passed in are in world coords.
@@ -1652,6 +1697,7 @@ void droidSetBits(const DROID_TEMPLATE *pTemplate, DROID *psDroid)
 		psDroid->asWeaps[inc].usedAmmo = 0;
 	}
 	memcpy(psDroid->asBits, pTemplate->asParts, sizeof(psDroid->asBits));
+	droidComponentsChanged(psDroid);
 
 	switch (getPropulsionStats(psDroid)->propulsionType)  // getPropulsionStats(psDroid) only defined after psDroid->asBits[COMP_PROPULSION] is set.
 	{
@@ -3033,6 +3079,7 @@ DROID *giftSingleDroid(DROID *psD, UDWORD to, bool electronic)
 				psD->asBits[COMP_REPAIRUNIT] = aDefaultRepair[psD->player];
 			}
 		}
+		droidComponentsChanged(psD);
 	}
 	else
 	{
@@ -93,10 +93,16 @@ UDWORD calcDroidPower(const DROID *psDroid);
 // Calculate the number of points required to build a droid
 UDWORD calcDroidPoints(DROID *psDroid);
 
+/// Must be called after changing the components or weapons of an existing droid.
+void droidComponentsChanged(DROID *psDroid);
+
+/// Must be called after changing the component upgrades of a player.
+void droidUpgradesChanged(int player);
+
 /* Calculate the body points of a droid from it's template */
 UDWORD calcTemplateBody(const DROID_TEMPLATE *psTemplate, UBYTE player);
 
-/* Calculate the base speed of a droid from it's template */
+/* Calculate the base speed of a droid from it's template. Droids keep the result in DROID::baseSpeed. */
 UDWORD calcDroidBaseSpeed(const DROID_TEMPLATE *psTemplate, UDWORD weight, UBYTE player);
 
 /* Calculate the speed of a droid over a terrain */
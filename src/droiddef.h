@@ -89,11 +89,25 @@ static inline DROID_TEMPLATE const *castDroidTemplate(BASE_STATS const *stats)
 class DROID_GROUP;
 struct STRUCTURE;
 
+/// Sums over the droid's components, cached because projectiles and AI ask for them all the time. See droidComponentsChanged() and droidUpgradesChanged().
+struct DROID_DERIVED_STATS
+{
+	bool            valid = false;                  ///< Cleared by droidComponentsChanged()
+	uint8_t         player = 0;                     ///< Player the values were worked out for
+	uint32_t        upgradeEpoch = 0;               ///< Upgrade epoch of player the values were worked out for
+	uint32_t        power = 0;                      ///< calcDroidPower()
+	uint32_t        points = 0;                     ///< calcDroidPoints()
+	uint32_t        baseBody = 0;                   ///< Body points including upgrades
+};
+
 struct DROID : public BASE_OBJECT
 {
 	DROID(uint32_t id, unsigned player);
 	~DROID();
 
+	static void *operator new(size_t size);         ///< Allocated from a pool, see objmemPoolStats()
+	static void operator delete(void *ptr);
+
 	/// UTF-8 name of the droid. This is generated from the droid template
 	///  WARNING: This *can* be changed by the game player after creation & can be translated, do NOT rely on this being the same for everyone!
 	char            aName[MAX_STR_LENGTH];
@@ -107,8 +121,9 @@ struct DROID : public BASE_OBJECT
 	 * but stored here for easy access
 	 */
 	UDWORD          weight;
-	UDWORD          baseSpeed;                      ///< the base speed dependent on propulsion type
+	UDWORD          baseSpeed;                      ///< the base speed dependent on propulsion type, calcDroidBaseSpeed() when the droid was built
 	UDWORD          originalBody;                   ///< the original body points
+	mutable DROID_DERIVED_STATS derivedStats;       ///< Only read through calcDroidPower() and friends
 	uint32_t        experience;
 	uint32_t        kills;
 	UDWORD          lastFrustratedTime;             ///< Set when eg being stuck; used for eg firing indiscriminately at map features to clear the way
@@ -69,6 +69,9 @@ struct FEATURE : public BASE_OBJECT
 	FEATURE(uint32_t id, FEATURE_STATS const *psStats);
 	~FEATURE();
 
+	static void *operator new(size_t size);         ///< Allocated from a pool, see objmemPoolStats()
+	static void operator delete(void *ptr);
+
 	FEATURE_STATS const *psStats;
 
 	inline Vector2i size() const { return psStats->size(); }
@@ -1863,6 +1863,8 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	/* Stop the game clock */
 	gameTimeStop();
 
+	saveJSONWaitForWrites();  // The game may have just been saved.
+
 	if ((gameType == GTYPE_SAVE_START) ||
 	    (gameType == GTYPE_SAVE_MIDMISSION))
 	{
@@ -2689,6 +2691,12 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	gameTimeStop();
 	sanityUpdate();
 
+	// The game state is collected into JSON documents here, and formatted and written to disk by a
+	// background thread, so the game only stops for as long as it takes to copy its state.
+	saveJSONWaitForWrites();  // WzConfig reads back files it is about to overwrite, so they must be complete.
+	int saveStartTime = wzGetTicks();
+	saveJSONBatchBegin();
+
 	/* Write the data to the file */
 	if (!writeGameFile(CurrentFileName, saveType))
 	{
@@ -2960,12 +2968,17 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	// strip the last filename
 	CurrentFileName[fileExtension - 1] = '\0';
 
+	saveJSONBatchEnd();
+	debug(LOG_SAVE, "Collected save state of %s in %d ms", CurrentFileName, wzGetTicks() - saveStartTime);
+
 	/* Start the game clock */
 	triggerEvent(TRIGGER_GAME_SAVED);
 	gameTimeStart();
 	return true;
 
 error:
+	saveJSONBatchEnd();
+
 	/* Start the game clock */
 	gameTimeStart();
 
@@ -5021,10 +5034,7 @@ static bool writeDroidFile(const char *pFileName, DROID **ppsCurrentDroidLists)
 		}
 	}
 
-	std::ostringstream stream;
-	stream << mRoot.dump(4) << std::endl;
-	std::string jsonString = stream.str();
-	saveFile(pFileName, jsonString.c_str(), jsonString.size());
+	saveJSONToFile(std::move(mRoot), pFileName);
 	debug(LOG_SAVE, "%s %s", "Saving", pFileName);
 
 	return true;
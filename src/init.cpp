@@ -31,6 +31,7 @@
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/wzapp.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/ivis_opengl/piemode.h"
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/screen.h"
@@ -457,6 +458,13 @@ bool rebuildSearchPath(searchPathMode mode, bool force, const char *current_map)
 		WZ_PHYSFS_unmount(PHYSFS_getWriteDir());
 		PHYSFS_mount(PHYSFS_getWriteDir(), NULL, PHYSFS_PREPEND);
 
+		// Parsed files of other mods are never used again
+		static std::string jsonCacheModList;
+		if (getModList() != jsonCacheModList)
+		{
+			jsonCacheClear();
+			jsonCacheModList = getModList();
+		}
 #ifdef DEBUG
 		printSearchPath();
 #endif // DEBUG
@@ -818,6 +826,8 @@ void systemShutdown()
 	frameShutDown();	// close screen / SDL / resources / cursors / trig
 	screenShutDown();
 	gfx_api::context::get().shutdown();
+	saveJSONWaitForWrites();	// finish writing the last savegame
+	jsonCacheClear();	// free parsed game data files
 	cleanSearchPath();	// clean PHYSFS search paths
 	debug_exit();		// cleanup debug routines
 	PHYSFS_deinit();	// cleanup PHYSFS (If failure, state of PhysFS is undefined, and probably badly screwed up.)
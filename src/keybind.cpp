@@ -634,8 +634,11 @@ void kf_ToggleOrders()	// Displays orders & action of currently selected unit.
 /* Writes out the frame rate */
 void	kf_FrameRate()
 {
-	CONPRINTF("FPS %d; PIEs %zu; polys %zu",
-	                          frameRate(), loopPieCount, loopPolyCount);
+	CONPRINTF("FPS %d; PIEs %zu; polys %zu; draws %zu; state changes %zu; objects visited %zu; widgets drawn %zu, changed %zu",
+	                          frameRate(), loopPieCount, loopPolyCount, loopDrawCount, loopStateChangeCount, loopObjectsVisitedCount,
+	                          loopWidgetsDisplayedCount, loopWidgetsChangedCount);
+	CONPRINTF("2D draws %zu for %zu lines, rectangles and images; text draws %zu",
+	                          loopBatch2DDrawCount, loopBatch2DCount, loopTextDrawCount);
 	if (runningMultiplayer())
 	{
 		CONPRINTF("NETWORK:  Bytes: s-%zu r-%zu  Uncompressed Bytes: s-%zu r-%zu  Packets: s-%zu r-%zu",
@@ -33,6 +33,7 @@
 #include "lib/framework/input.h"
 #include "lib/framework/stdio_ext.h"
 #include "lib/framework/wztime.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/widget/button.h"
 #include "lib/widget/editbox.h"
 #include "lib/widget/widget.h"
@@ -166,6 +167,9 @@ bool addLoadSave(LOADSAVE_MODE savemode, const char *title)
 	static char	sSlotCaps[totalslots][totalslotspace];
 	static char	sSlotTips[totalslots][totalslotspace];
 
+	// The slots list savegames, and may be loaded or overwritten, so the last save must be complete first.
+	saveJSONWaitForWrites();
+
 	switch (savemode)
 	{
 	case LOAD_FRONTEND_MISSION:
@@ -449,6 +453,8 @@ void deleteSaveGame(char *fileName)
 {
 	ASSERT(strlen(fileName) < MAX_STR_LENGTH, "deleteSaveGame; save game name too long");
 
+	saveJSONWaitForWrites();  // Don't delete files that are still being written.
+
 	PHYSFS_delete(fileName);
 	fileName[strlen(fileName) - 4] = '\0'; // strip extension
 
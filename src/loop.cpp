@@ -99,6 +99,14 @@
  */
 size_t loopPieCount;
 size_t loopPolyCount;
+size_t loopDrawCount;
+size_t loopStateChangeCount;
+size_t loopObjectsVisitedCount;
+size_t loopWidgetsDisplayedCount;
+size_t loopWidgetsChangedCount;
+size_t loopBatch2DDrawCount;
+size_t loopBatch2DCount;
+size_t loopTextDrawCount;
 
 /*
  * local variables
@@ -290,22 +298,26 @@ static GAMECODE renderLoop()
 			pie_LoadBackDrop(SCREEN_RANDOMBDROP);
 		}
 	}
-	if (!loop_GetVideoStatus() && !quitting && !headlessGameMode())
+	// With --gfxstats, headless games are drawn too (to the null backend), to measure the cost of drawing
+	if (!loop_GetVideoStatus() && !quitting && (!headlessGameMode() || gfxstats_enabled()))
 	{
 		if (!gameUpdatePaused())
 		{
-			if (dragBox3D.status != DRAG_DRAGGING
-			    && wallDrag.status != DRAG_DRAGGING
-			    && intRetVal != INT_INTERCEPT)
+			if (!headlessGameMode())
 			{
-				ProcessRadarInput();
-			}
-			processInput();
+				if (dragBox3D.status != DRAG_DRAGGING
+				    && wallDrag.status != DRAG_DRAGGING
+				    && intRetVal != INT_INTERCEPT)
+				{
+					ProcessRadarInput();
+				}
+				processInput();
 
-			//no key clicks or in Intelligence Screen
-			if (!isMouseOverRadar() && !isDraggingInGameNotification() && !isMouseClickDownOnScreenOverlayChild() && intRetVal == INT_NONE && !InGameOpUp && !isInGamePopupUp)
-			{
-				processMouseClickInput();
+				//no key clicks or in Intelligence Screen
+				if (!isMouseOverRadar() && !isDraggingInGameNotification() && !isMouseClickDownOnScreenOverlayChild() && intRetVal == INT_NONE && !InGameOpUp && !isInGamePopupUp)
+				{
+					processMouseClickInput();
+				}
 			}
 			bRender3DOnly = false;
 			displayWorld();
@@ -329,6 +341,10 @@ static GAMECODE renderLoop()
 	}
 
 	pie_GetResetCounts(&loopPieCount, &loopPolyCount);
+	pie_GetResetDrawCounts(&loopDrawCount, &loopStateChangeCount);
+	loopObjectsVisitedCount = displayGetResetObjectsVisited();
+	widgGetResetDisplayCounts(&loopWidgetsDisplayedCount, &loopWidgetsChangedCount);
+	pie_GetResetBatch2DCounts(&loopBatch2DDrawCount, &loopBatch2DCount, &loopTextDrawCount);
 
 	if (!quitting)
 	{
@@ -55,6 +55,14 @@ extern LEVEL_TYPE nextMissionType;
 
 extern size_t loopPieCount;
 extern size_t loopPolyCount;
+extern size_t loopDrawCount;
+extern size_t loopStateChangeCount;
+extern size_t loopObjectsVisitedCount;
+extern size_t loopWidgetsDisplayedCount;
+extern size_t loopWidgetsChangedCount;
+extern size_t loopBatch2DDrawCount;
+extern size_t loopBatch2DCount;
+extern size_t loopTextDrawCount;
 
 GAMECODE gameLoop();
 void videoLoop();
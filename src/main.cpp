@@ -1459,9 +1459,17 @@ int realmain(int argc, char *argv[])
 		{
 			fprintf(stdout, " * NOTE: VSYNC IS DISABLED - CPU USAGE MAY BE UNBOUNDED\n");
 		}
+		if (gfxstats_enabled())
+		{
+			fprintf(stdout, " * Drawing frames and recording draw statistics (--gfxstats)\n");
+		}
 		fprintf(stdout, "--------------------------------------------------------------------------------------\n");
 		fflush(stdout);
 	}
+	else if (gfxstats_enabled())
+	{
+		debug(LOG_WARNING, "--gfxstats only records draw statistics in headless mode");
+	}
 
 	// Find out where to find the data
 	scanDataDirs();
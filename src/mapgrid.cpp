@@ -171,6 +171,17 @@ GridList const &gridStartIterateArea(int32_t x, int32_t y, uint32_t x2, uint32_t
 	return gridStartIterateFilteredArea(x, y, x2, y2, ConditionTrue());
 }
 
+void gridQueryArea(std::vector<GridPoint> &results, int32_t x, int32_t y, int32_t x2, int32_t y2)
+{
+	static std::vector<PointTree::IndexedPoint> points;  // static to avoid allocations.
+	points.clear();
+	gridPointTree->queryIndexed(points, x, y, x2, y2);
+	for (const PointTree::IndexedPoint &point : points)
+	{
+		results.push_back({point.index, Vector2i(point.x, point.y), static_cast<BASE_OBJECT *>(point.data)});
+	}
+}
+
 struct ConditionDroidsByPlayer
 {
 	ConditionDroidsByPlayer(int32_t player_) : player(player_) {}
@@ -27,6 +27,14 @@
 typedef std::vector<BASE_OBJECT *> GridList;
 typedef GridList::const_iterator GridIterator;
 
+/// Object found by gridQueryArea().
+struct GridPoint
+{
+	unsigned index;         ///< All grid searches return objects in order of increasing index.
+	Vector2i pos;           ///< Object position at the last gridReset(), which is what the searches look at before checking the radius.
+	BASE_OBJECT *psObj;
+};
+
 // initialise the grid system
 bool gridInitialise();
 
@@ -46,6 +54,10 @@ GridList const &gridStartIterateArea(int32_t x, int32_t y, uint32_t x2, uint32_t
 /// Find all objects within radius where object->type == OBJ_DROID && object->player == player.
 GridList const &gridStartIterateDroidsByPlayer(int32_t x, int32_t y, uint32_t radius, int player);
 
+/// Append all objects whose position at the last gridReset() was within [x, x2] × [y, y2] to results. Unlike the
+/// other searches, this keeps the index and grid position, so callers can do many nearby searches from one result.
+void gridQueryArea(std::vector<GridPoint> &results, int32_t x, int32_t y, int32_t x2, int32_t y2);
+
 // Used for visibility.
 /// Find all objects within radius where object->seenThisTick[player] != 255.
 GridList const &gridStartIterateUnseen(int32_t x, int32_t y, uint32_t radius, int player);
@@ -0,0 +1,118 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2020  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Fixed size object pool, used for the memory of game objects.
+ */
+
+#ifndef __INCLUDED_SRC_OBJECTPOOL_H__
+#define __INCLUDED_SRC_OBJECTPOOL_H__
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/// Hands out memory for objects of type T from slabs of SlabSize objects. Memory never moves, and freed
+/// memory is kept on a free list and handed out again, most recently freed first. Not thread safe.
+template <typename T, size_t SlabSize = 256>
+class ObjectPool
+{
+public:
+	ObjectPool(const ObjectPool &) = delete;
+	ObjectPool &operator =(const ObjectPool &) = delete;
+	ObjectPool(const char *name) : poolName(name) {}
+
+	void *allocate()
+	{
+		if (freeList == nullptr)
+		{
+			addSlab();
+		}
+		Slot *slot = freeList;
+		freeList = slot->next;
+		++numLive;
+		numPeak = std::max(numPeak, numLive);
+		return slot->storage;
+	}
+
+	void deallocate(void *ptr)
+	{
+		if (ptr == nullptr)
+		{
+			return;
+		}
+		Slot *slot = reinterpret_cast<Slot *>(ptr);
+		slot->next = freeList;
+		freeList = slot;
+		--numLive;
+	}
+
+	/// Give the memory back to the system, if no object is using it.
+	void trim()
+	{
+		if (numLive == 0)
+		{
+			slabs.clear();
+			freeList = nullptr;
+		}
+	}
+
+	const char *name() const
+	{
+		return poolName;
+	}
+	size_t live() const	///< Number of objects allocated from the pool.
+	{
+		return numLive;
+	}
+	size_t peak() const	///< Highest number of objects that were allocated at the same time.
+	{
+		return numPeak;
+	}
+	size_t free() const	///< Number of objects that fit in the pool without allocating another slab.
+	{
+		return slabs.size() * SlabSize - numLive;
+	}
+
+private:
+	union Slot
+	{
+		Slot *next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	void addSlab()
+	{
+		slabs.emplace_back(new Slot[SlabSize]);
+		Slot *slab = slabs.back().get();
+		// Link backwards, so that objects are handed out in address order.
+		for (size_t i = SlabSize; i-- > 0;)
+		{
+			slab[i].next = freeList;
+			freeList = &slab[i];
+		}
+	}
+
+	const char *poolName;
+	std::vector<std::unique_ptr<Slot[]>> slabs;
+	Slot *freeList = nullptr;
+	size_t numLive = 0;
+	size_t numPeak = 0;
+};
+
+#endif // __INCLUDED_SRC_OBJECTPOOL_H__
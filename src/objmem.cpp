@@ -41,6 +41,8 @@
 #include "combat.h"
 #include "visibility.h"
 #include "qtscript.h"
+#include "projectiledef.h"
+#include "objectpool.h"
 
 // the initial value for the object ID
 #define OBJ_ID_INIT 20000
@@ -65,6 +67,32 @@ FLAG_POSITION	*apsFlagPosLists[MAX_PLAYERS];
 /* The list of destroyed objects */
 BASE_OBJECT		*psDestroyedObj = nullptr;
 
+static uint32_t listGeneration = 0;  ///< Changed whenever an object is added to or removed from an object list.
+
+/* The memory of the game objects. Destroyed objects go back to their pool when objmemUpdate() frees them. */
+static ObjectPool<DROID>	droidPool("droid");
+static ObjectPool<STRUCTURE>	structurePool("structure");
+static ObjectPool<FEATURE>	featurePool("feature");
+static ObjectPool<PROJECTILE>	projectilePool("projectile");
+
+#define OBJMEM_POOL_OPERATORS(TYPE, pool) \
+	void *TYPE::operator new(size_t size) \
+	{ \
+		ASSERT(size == sizeof(TYPE), "Unexpected size %zu for " #TYPE, size); \
+		return pool.allocate(); \
+	} \
+	void TYPE::operator delete(void *ptr) \
+	{ \
+		pool.deallocate(ptr); \
+	}
+
+OBJMEM_POOL_OPERATORS(DROID, droidPool)
+OBJMEM_POOL_OPERATORS(STRUCTURE, structurePool)
+OBJMEM_POOL_OPERATORS(FEATURE, featurePool)
+OBJMEM_POOL_OPERATORS(PROJECTILE, projectilePool)
+
+#undef OBJMEM_POOL_OPERATORS
+
 /* Forward function declarations */
 #ifdef DEBUG
 static void objListIntegCheck();
@@ -84,6 +112,25 @@ bool objmemInitialise()
 /* Release the object heaps */
 void objmemShutdown()
 {
+	for (const OBJMEM_POOL_STATS &stats : objmemPoolStats())
+	{
+		debug(LOG_MEMORY, "%s pool: %zu live, %zu peak, %zu free", stats.name, stats.live, stats.peak, stats.free);
+	}
+	droidPool.trim();
+	structurePool.trim();
+	featurePool.trim();
+	projectilePool.trim();
+}
+
+template <typename T>
+static OBJMEM_POOL_STATS poolStats(const ObjectPool<T> &pool)
+{
+	return {pool.name(), pool.live(), pool.peak(), pool.free()};
+}
+
+std::vector<OBJMEM_POOL_STATS> objmemPoolStats()
+{
+	return {poolStats(droidPool), poolStats(structurePool), poolStats(featurePool), poolStats(projectilePool)};
 }
 
 // Check that psVictim is not referred to by any other object in the game. We can dump out some extra data in debug builds that help track down sources of dangling pointer errors.
@@ -203,6 +250,11 @@ void objmemUpdate()
 	}
 }
 
+uint32_t objmemListGeneration()
+{
+	return listGeneration;
+}
+
 uint32_t generateNewObjectId()
 {
 	// Generate even ID for unsynchronized objects. This is needed for debug objects, templates and other border lines cases that should preferably be removed one day.
@@ -228,6 +280,7 @@ static inline void addObjectToList(OBJECT *list[], OBJECT *object, int player)
 	// Prepend the object to the top of the list
 	object->psNext = list[player];
 	list[player] = object;
+	++listGeneration;
 }
 
 /* Add the object to its list
@@ -253,6 +306,7 @@ static inline void destroyObject(OBJECT *list[], OBJECT *object)
 {
 	ASSERT_OR_RETURN(, object != nullptr, "Invalid pointer");
 	ASSERT(gameTime - deltaGameTime <= gameTime || gameTime == 2, "Expected %u <= %u, bad time", gameTime - deltaGameTime, gameTime);
+	++listGeneration;
 
 	// If the message to remove is the first one in the list then mark the next one as the first
 	if (list[object->player] == object)
@@ -299,6 +353,7 @@ template <typename OBJECT>
 static inline void removeObjectFromList(OBJECT *list[], OBJECT *object, int player)
 {
 	ASSERT_OR_RETURN(, object != nullptr, "Invalid pointer");
+	++listGeneration;
 
 	// If the message to remove is the first one in the list then mark the next one as the first
 	if (list[player] == object)
@@ -357,6 +412,7 @@ static inline void removeObjectFromFuncList(OBJECT *list[], OBJECT *object, int
 template <typename OBJECT>
 static inline void releaseAllObjectsInList(OBJECT *list[])
 {
+	++listGeneration;
 	// Iterate through all players' object lists
 	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
 	{
@@ -26,6 +26,8 @@
 
 #include "objectdef.h"
 
+#include <vector>
+
 /* The lists of objects allocated */
 extern DROID			*apsDroidLists[MAX_PLAYERS];
 extern STRUCTURE		*apsStructLists[MAX_PLAYERS];
@@ -47,6 +49,22 @@ void objmemShutdown();
 /* General housekeeping for the object system */
 void objmemUpdate();
 
+/// Memory use of one of the game object pools.
+struct OBJMEM_POOL_STATS
+{
+	const char *name;
+	size_t live;        ///< Objects currently allocated
+	size_t peak;        ///< Most objects allocated at the same time
+	size_t free;        ///< Objects that fit without allocating more memory
+};
+
+/// Memory use of the droid, structure, feature and projectile pools.
+std::vector<OBJMEM_POOL_STATS> objmemPoolStats();
+
+/// Changes whenever an object is added to or removed from one of the object lists. Lists that are swapped
+/// wholesale, such as the mission lists, are not tracked.
+uint32_t objmemListGeneration();
+
 /// Generates a new, (hopefully) unique object id.
 uint32_t generateNewObjectId();
 /// Generates a new, (hopefully) unique object id, which all clients agree on.
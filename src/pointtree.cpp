@@ -50,6 +50,18 @@ static uint64_t expand(uint32_t x)
 	return r;
 }
 
+// Compacts bit pattern 0a0b 0c0d 0e0f 0g0h to abcd efgh, the inverse of expand()
+static uint32_t compact(uint64_t r)
+{
+	r &= 0x5555555555555555ULL;
+	r = (r | r >> 1)  & 0x3333333333333333ULL;
+	r = (r | r >> 2)  & 0x0F0F0F0F0F0F0F0FULL;
+	r = (r | r >> 4)  & 0x00FF00FF00FF00FFULL;
+	r = (r | r >> 8)  & 0x0000FFFF0000FFFFULL;
+	r = (r | r >> 16) & 0x00000000FFFFFFFFULL;
+	return r;
+}
+
 // Returns v with highest set bit and all higher bits set, and all following bits 0. Example: 0000 0110 1001 1100 -> 1111 1100 0000 0000.
 static uint32_t findSplit(uint32_t v)
 {
@@ -95,6 +107,7 @@ static bool pointTreeSortFunction(std::pair<uint64_t, void *> const &a, std::pai
 void PointTree::sort()
 {
 	std::stable_sort(points.begin(), points.end(), pointTreeSortFunction);  // Stable sort to avoid unspecified behaviour when two objects are in exactly the same place.
+	noFilter.reset(*this);
 }
 
 //#define DUMP_IMAGE  // All x and y coordinates must be in range -500 to 499, if dumping an image.
@@ -276,6 +289,21 @@ PointTree::ResultVector &PointTree::query(int32_t x, int32_t y, uint32_t x2, uin
 	return queryMaybeFilter<false>(unused, x, y, x2, y2);
 }
 
+void PointTree::queryIndexed(std::vector<IndexedPoint> &results, int32_t x, int32_t y, int32_t x2, int32_t y2)
+{
+	queryMaybeFilter<true>(noFilter, x, y, x2, y2);  // noFilter is never erased from, so this only records the indices.
+	for (size_t n = 0; n != lastQueryResults.size(); ++n)
+	{
+		unsigned i = lastFilteredQueryIndices[n];
+		IndexedPoint point;
+		point.index = i;
+		point.x = compact(points[i].first >> 1) - 0x80000000u;
+		point.y = compact(points[i].first) - 0x80000000u;
+		point.data = points[i].second;
+		results.push_back(point);
+	}
+}
+
 PointTree::ResultVector &PointTree::query(int32_t x, int32_t y, uint32_t radius)
 {
 	Filter unused;
@@ -66,6 +66,16 @@ public:
 	/// Returns all points which have not been filtered away within given rectangle. See function above on thread safety.
 	ResultVector &query(int32_t x, int32_t y, uint32_t x2, uint32_t y2);
 
+	struct IndexedPoint
+	{
+		unsigned index;  ///< Position in the sorted tree. Query results are always in order of increasing index.
+		int32_t x, y;    ///< Coordinates the point was inserted with.
+		void *data;
+	};
+	/// Appends all points within the rectangle [x, x2] × [y, y2] to results, in order of increasing index.
+	/// Note: Not thread safe, because it modifies lastQueryResults and lastFilteredQueryIndices.
+	void queryIndexed(std::vector<IndexedPoint> &results, int32_t x, int32_t y, int32_t x2, int32_t y2);
+
 	ResultVector lastQueryResults;
 	IndexVector lastFilteredQueryIndices;
 
@@ -77,6 +87,7 @@ private:
 	ResultVector &queryMaybeFilter(Filter &filter, int32_t minXo, int32_t maxXo, int32_t minYo, int32_t maxYo);
 
 	Vector points;
+	Filter noFilter;  ///< Filter which doesn't filter anything, for queries which need lastFilteredQueryIndices.
 };
 
 #endif //_point_tree_h
@@ -92,6 +92,10 @@ struct DAMAGE
 // Watermelon:they are from droid.c
 /* The range for neighbouring objects */
 #define PROJ_NEIGHBOUR_RANGE (TILE_UNITS*4)
+/* Size of the cells proj_Broadphase() searches the grid with */
+#define PROJ_BROADPHASE_CELL (TILE_UNITS*8)
+/* Projectiles which could reach more cells than this in one tick search the grid on their own */
+#define PROJ_BROADPHASE_MAX_CELLS 16
 // used to create a specific ID for projectile objects to facilitate tracking them.
 static const uint32_t ProjectileTrackerID = 0xdead0000;
 static uint32_t projectileTrackerIDIncrement = 0;
@@ -102,6 +106,18 @@ static std::vector<PROJECTILE *> psProjectileList;
 /* The next projectile to give out in the proj_First / proj_Next methods */
 static ProjectileIterator psProjectileNext;
 
+/// Objects which a projectile could collide with this tick, found by proj_Broadphase().
+struct PROJ_CANDIDATES
+{
+	bool valid = false;
+	Vector2i min, max;  ///< Area searched. Only a neighbour search which fits inside can use the candidates.
+	size_t begin = 0, end = 0;  ///< Range in projCandidates.
+};
+
+static std::vector<GridPoint> projCandidates;  ///< Sorted by projectile, then grid index.
+static std::vector<PROJ_CANDIDATES> projCandidateAreas;  ///< Indexed like the list passed to proj_Broadphase().
+static const PROJ_CANDIDATES *projCurrentCandidates = nullptr;  ///< Candidates of the projectile being updated.
+
 /***************************************************************************/
 
 // the last unit that did damage - used by script functions
@@ -679,6 +695,118 @@ static int32_t collisionXYZ(Vector3i v1, Vector3i v2, ObjectShape shape, int32_t
 	return -1;
 }
 
+static inline int32_t proj_BroadphaseCell(int32_t coord)
+{
+	return coord >= 0 ? coord / PROJ_BROADPHASE_CELL : -((-coord - 1) / PROJ_BROADPHASE_CELL) - 1;
+}
+
+/// Finds the objects near where each of the projectiles could get to this tick, with one grid search per
+/// cell of the map that any projectile could reach, rather than one grid search per projectile.
+static void proj_Broadphase(const std::vector<PROJECTILE *> &list)
+{
+	static std::vector<std::pair<uint64_t, unsigned>> cellProjectiles;  // (cell, index in list), static to avoid allocations.
+	static std::vector<std::pair<unsigned, GridPoint>> found;
+	static std::vector<GridPoint> cellObjects;
+	cellProjectiles.clear();
+	found.clear();
+	projCandidates.clear();
+	projCandidateAreas.assign(list.size(), PROJ_CANDIDATES());
+
+	for (unsigned n = 0; n < list.size(); ++n)
+	{
+		const PROJECTILE *psProj = list[n];
+		if (psProj->state != PROJ_INFLIGHT || psProj->psWStats == nullptr)
+		{
+			continue;
+		}
+		// No movement model moves a projectile further than its speed in either direction per tick, give or take rounding.
+		int speed = std::max<int>(psProj->psWStats->flightSpeed, psProj->vXY);
+		int reach = (int64_t)speed * (gameTime - psProj->time) / GAME_TICKS_PER_SEC + 8 + PROJ_NEIGHBOUR_RANGE;
+		PROJ_CANDIDATES &area = projCandidateAreas[n];
+		area.min = psProj->pos.xy() - Vector2i(reach, reach);
+		area.max = psProj->pos.xy() + Vector2i(reach, reach);
+		int32_t cellX1 = proj_BroadphaseCell(area.min.x), cellX2 = proj_BroadphaseCell(area.max.x);
+		int32_t cellY1 = proj_BroadphaseCell(area.min.y), cellY2 = proj_BroadphaseCell(area.max.y);
+		if ((cellX2 - cellX1 + 1) * (cellY2 - cellY1 + 1) > PROJ_BROADPHASE_MAX_CELLS)
+		{
+			continue;
+		}
+		area.valid = true;
+		for (int32_t cellY = cellY1; cellY <= cellY2; ++cellY)
+		{
+			for (int32_t cellX = cellX1; cellX <= cellX2; ++cellX)
+			{
+				cellProjectiles.emplace_back((uint64_t)(uint32_t)cellX << 32 | (uint32_t)cellY, n);
+			}
+		}
+	}
+	std::sort(cellProjectiles.begin(), cellProjectiles.end());
+
+	for (auto i = cellProjectiles.begin(); i != cellProjectiles.end();)
+	{
+		auto cellEnd = std::find_if(i, cellProjectiles.end(), [&](std::pair<uint64_t, unsigned> const &p) { return p.first != i->first; });
+		int32_t x = (int32_t)(uint32_t)(i->first >> 32) * PROJ_BROADPHASE_CELL;
+		int32_t y = (int32_t)(uint32_t)i->first * PROJ_BROADPHASE_CELL;
+		cellObjects.clear();
+		gridQueryArea(cellObjects, x, y, x + PROJ_BROADPHASE_CELL - 1, y + PROJ_BROADPHASE_CELL - 1);
+		for (; i != cellEnd; ++i)
+		{
+			const PROJ_CANDIDATES &area = projCandidateAreas[i->second];
+			for (const GridPoint &point : cellObjects)
+			{
+				if (point.pos.x >= area.min.x && point.pos.x <= area.max.x && point.pos.y >= area.min.y && point.pos.y <= area.max.y)
+				{
+					found.emplace_back(i->second, point);
+				}
+			}
+		}
+	}
+
+	// Each object is in exactly one cell, so this just needs putting into grid order.
+	std::sort(found.begin(), found.end(), [](std::pair<unsigned, GridPoint> const &a, std::pair<unsigned, GridPoint> const &b) {
+		return a.first != b.first ? a.first < b.first : a.second.index < b.second.index;
+	});
+	for (auto const &entry : found)
+	{
+		PROJ_CANDIDATES &area = projCandidateAreas[entry.first];
+		if (area.begin == area.end)
+		{
+			area.begin = area.end = projCandidates.size();
+		}
+		projCandidates.push_back(entry.second);
+		++area.end;
+	}
+}
+
+/// Finds the same objects, in the same order, as gridStartIterate(psProj->pos.x, psProj->pos.y, PROJ_NEIGHBOUR_RANGE).
+static void proj_FindNeighbours(const PROJECTILE *psProj, GridList &gridList)
+{
+	const int32_t x = psProj->pos.x, y = psProj->pos.y;
+	const int32_t minX = x - PROJ_NEIGHBOUR_RANGE, maxX = x + PROJ_NEIGHBOUR_RANGE;
+	const int32_t minY = y - PROJ_NEIGHBOUR_RANGE, maxY = y + PROJ_NEIGHBOUR_RANGE;
+	const PROJ_CANDIDATES *area = projCurrentCandidates;
+	if (area == nullptr || !area->valid || minX < area->min.x || maxX > area->max.x || minY < area->min.y || maxY > area->max.y)
+	{
+		gridList = gridStartIterate(x, y, PROJ_NEIGHBOUR_RANGE);
+		return;
+	}
+
+	gridList.clear();
+	for (size_t i = area->begin; i < area->end; ++i)
+	{
+		const GridPoint &point = projCandidates[i];
+		if (point.pos.x < minX || point.pos.x > maxX || point.pos.y < minY || point.pos.y > maxY)
+		{
+			continue;  // Wouldn't be in the square gridStartIterate() searches.
+		}
+		const Vector2i diff = point.psObj->pos.xy() - Vector2i(x, y);
+		if ((int64_t)diff.x * diff.x + (int64_t)diff.y * diff.y <= (int64_t)PROJ_NEIGHBOUR_RANGE * PROJ_NEIGHBOUR_RANGE)
+		{
+			gridList.push_back(point.psObj);
+		}
+	}
+}
+
 static void proj_InFlightFunc(PROJECTILE *psProj)
 {
 	/* we want a delay between Las-Sats firing and actually hitting in multiPlayer
@@ -802,7 +930,7 @@ static void proj_InFlightFunc(PROJECTILE *psProj)
 
 	/* Check nearby objects for possible collisions */
 	static GridList gridList;  // static to avoid allocations.
-	gridList = gridStartIterate(psProj->pos.x, psProj->pos.y, PROJ_NEIGHBOUR_RANGE);
+	proj_FindNeighbours(psProj, gridList);
 	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
 	{
 		BASE_OBJECT *psTempObj = *gi;
@@ -1357,8 +1485,15 @@ void proj_UpdateAll()
 {
 	std::vector<PROJECTILE *> psProjectileListOld = psProjectileList;
 
+	proj_Broadphase(psProjectileListOld);
+
 	// Update all projectiles. Penetrating projectiles may add to psProjectileList.
-	std::for_each(psProjectileListOld.begin(), psProjectileListOld.end(), std::mem_fn(&PROJECTILE::update));
+	for (size_t n = 0; n < psProjectileListOld.size(); ++n)
+	{
+		projCurrentCandidates = &projCandidateAreas[n];
+		psProjectileListOld[n]->update();
+	}
+	projCurrentCandidates = nullptr;
 
 	// Remove and free dead projectiles.
 	psProjectileList.erase(std::remove_if(psProjectileList.begin(), psProjectileList.end(), std::mem_fn(&PROJECTILE::deleteIfDead)), psProjectileList.end());
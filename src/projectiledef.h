@@ -42,6 +42,9 @@ struct PROJECTILE : public SIMPLE_OBJECT
 {
 	PROJECTILE(uint32_t id, unsigned player) : SIMPLE_OBJECT(OBJ_PROJECTILE, id, player) {}
 
+	static void *operator new(size_t size);         ///< Allocated from a pool, see objmemPoolStats()
+	static void operator delete(void *ptr);
+
 	void            update();
 	bool            deleteIfDead()
 	{
@@ -197,6 +197,9 @@ scripting_engine::area_by_values_or_area_label_lookup::area_by_values_or_area_la
 #define MAX_US 20000
 #define HALF_MAX_US 10000
 
+/// Repeating timers with the same period are spread over at most this many milliseconds of game ticks.
+#define MAX_TIMER_SPREAD_MS 1000
+
 
 uniqueTimerID scripting_engine::getNextAvailableTimerID()
 {
@@ -217,6 +220,20 @@ uniqueTimerID scripting_engine::setTimer(wzapi::scripting_instance *caller, cons
 	}
 	node->type = type;
 	node->timerID = newTimerID;
+	if (type == TIMER_REPEAT)
+	{
+		// AIs tend to set many timers with the same period at once, so delay the first call of each by a different number
+		// of game ticks, instead of running them all in the same tick. This only depends on the order of the setTimer calls
+		// made by the same script instance, so it is the same on all clients running that script.
+		int slots = std::min(milliseconds, MAX_TIMER_SPREAD_MS) / GAME_TICKS_PER_UPDATE;
+		unsigned &count = repeatTimerPeriodCounts[std::make_pair(caller, milliseconds)];
+		if (slots > 1)
+		{
+			node->frameTime += (count % slots) * GAME_TICKS_PER_UPDATE;
+		}
+		++count;
+	}
+	scheduleTimer(node);
 	auto inserted_iter = timers.emplace(timers.end(), std::move(node));
 	timerIDMap[newTimerID] = inserted_iter;
 	return newTimerID;
@@ -226,10 +243,33 @@ uniqueTimerID scripting_engine::setTimer(wzapi::scripting_instance *caller, cons
 void scripting_engine::addTimerNode(std::shared_ptr<scripting_engine::timerNode>&& node)
 {
 	ASSERT(timerIDMap.count(node->timerID) == 0, "Duplicate timerID found: %s", WzString::number(node->timerID).toUtf8().c_str());
+	if (node->type == TIMER_ONESHOT_DONE)
+	{
+		doneOneShotTimers.push_back(node->timerID);
+	}
+	else
+	{
+		scheduleTimer(node);
+	}
 	auto inserted_iter = timers.emplace(timers.end(), std::move(node));
 	timerIDMap[(*inserted_iter)->timerID] = inserted_iter;
 }
 
+void scripting_engine::scheduleTimer(const std::shared_ptr<timerNode>& node)
+{
+	// Drop stale entries, if they are taking up most of the queue.
+	if (timerQueue.size() > 2 * timers.size() + 64)
+	{
+		timerQueue.erase(std::remove_if(timerQueue.begin(), timerQueue.end(), [](const timerQueueEntry &entry) {
+			std::shared_ptr<timerNode> queued = entry.node.lock();
+			return !queued || queued->type == TIMER_REMOVED || queued->frameTime != entry.frameTime;
+		}), timerQueue.end());
+		std::make_heap(timerQueue.begin(), timerQueue.end(), std::greater<timerQueueEntry>());
+	}
+	timerQueue.push_back(timerQueueEntry{node->frameTime, timerQueueSequence++, node});
+	std::push_heap(timerQueue.begin(), timerQueue.end(), std::greater<timerQueueEntry>());
+}
+
 /// Scripting engine (what others call the scripting context, but QtScript's nomenclature is different).
 static std::vector<wzapi::scripting_instance *> scripts;
 
@@ -421,6 +461,10 @@ bool scripting_engine::shutdownScripts()
 	timers.clear();
 	lastTimerID = 0;
 	timerIDMap.clear();
+	timerQueue.clear();
+	timerQueueSequence = 0;
+	doneOneShotTimers.clear();
+	repeatTimerPeriodCounts.clear();
 	monitors.clear();
 	for (auto& script : scripts)
 	{
@@ -453,24 +497,45 @@ bool scripting_engine::updateScripts()
 		instance->updateGameTime(gameTime);
 	}
 	// Weed out dead timers
-	removeTimersIf([](const timerNode& node)
+	for (uniqueTimerID timerID : doneOneShotTimers)
 	{
-		return (node.type == TIMER_ONESHOT_DONE);
-	});
-	// Check for timers, and run them if applicable.
-	// TODO - load balancing
+		auto it = timerIDMap.find(timerID);
+		if (it != timerIDMap.end() && (*it->second)->type == TIMER_ONESHOT_DONE)
+		{
+			removeTimer(timerID);
+		}
+	}
+	doneOneShotTimers.clear();
+	// Check for timers, and run them if applicable, earliest first.
 	std::vector<std::shared_ptr<timerNode>> runlist; // make a new list here, since we might trample all over the timer list during execution
-	for (auto &node : timers)
+	while (!timerQueue.empty() && timerQueue.front().frameTime <= (int)gameTime)
 	{
-		if (node->frameTime <= gameTime)
+		std::pop_heap(timerQueue.begin(), timerQueue.end(), std::greater<timerQueueEntry>());
+		timerQueueEntry entry = std::move(timerQueue.back());
+		timerQueue.pop_back();
+		std::shared_ptr<timerNode> node = entry.node.lock();
+		if (!node || node->type == TIMER_REMOVED || node->frameTime != entry.frameTime)
 		{
-			node->frameTime = node->ms + gameTime;	// update for next invokation
-			if (node->type == TIMER_ONESHOT_READY)
-			{
-				node->type = TIMER_ONESHOT_DONE; // unless there is none
-			}
-			node->calls++;
-			runlist.push_back(node);
+			continue; // stale entry
+		}
+		node->frameTime = node->ms + gameTime;	// update for next invokation
+		if (node->type == TIMER_ONESHOT_READY)
+		{
+			node->type = TIMER_ONESHOT_DONE; // unless there is none
+		}
+		node->calls++;
+		runlist.push_back(node);
+	}
+	// Reschedule after collecting the runlist, so that a timer runs at most once per update, even with a period of 0.
+	for (auto &node : runlist)
+	{
+		if (node->type == TIMER_ONESHOT_DONE)
+		{
+			doneOneShotTimers.push_back(node->timerID);
+		}
+		else
+		{
+			scheduleTimer(node);
 		}
 	}
 
@@ -1158,6 +1223,7 @@ bool triggerEvent(SCRIPT_TRIGGER_TYPE trigger, BASE_OBJECT *psObj)
 	if ((trigger == TRIGGER_START_LEVEL || trigger == TRIGGER_GAME_LOADED) && !saveandquit_enabled().empty())
 	{
 		saveGame(saveandquit_enabled().c_str(), GTYPE_SAVE_START);
+		saveJSONWaitForWrites();
 		exit(0);
 	}
 
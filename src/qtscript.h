@@ -325,12 +325,30 @@ private:
 	typedef std::map<wzapi::scripting_instance *, GROUPMAP *> ENGINEMAP;
 	ENGINEMAP groups;
 
-	/// List of timer events for scripts. Before running them, we sort the list then run as many as we have time for.
-	/// In this way, we implement load balancing of events and keep frame rates tidy for users. Since scripts run on the
-	/// host, we do not need to worry about each peer simulating the world differently.
+	/// Entry in the timer queue. An entry is stale, and skipped, if its timer was removed or rescheduled after the entry was pushed.
+	struct timerQueueEntry
+	{
+		int frameTime;
+		uint64_t sequence;               ///< Timers due at the same time run in the order they were scheduled.
+		std::weak_ptr<timerNode> node;
+		bool operator >(const timerQueueEntry &rhs) const
+		{
+			return frameTime != rhs.frameTime ? frameTime > rhs.frameTime : sequence > rhs.sequence;
+		}
+	};
+
+	/// List of timer events for scripts, in the order they were added (and saved).
 	std::list<std::shared_ptr<timerNode>> timers;
 	uniqueTimerID lastTimerID = 0;
 	std::unordered_map<uniqueTimerID, std::list<std::shared_ptr<timerNode>>::iterator> timerIDMap; // a map from uniqueTimerID -> entry in the timers list
+	/// Min-heap of the timers by (frameTime, sequence), so that we only look at due timers, and always run them in the same
+	/// order on all clients. Timers with the same period are spread over game ticks when set, see setTimer().
+	std::vector<timerQueueEntry> timerQueue;
+	uint64_t timerQueueSequence = 0;
+	std::vector<uniqueTimerID> doneOneShotTimers;                  ///< One-shot timers which ran in the last update, to remove in the next.
+	/// Number of repeating timers set per (script instance, period), for spreading them. Counted per instance, since AI
+	/// and scavenger scripts only run on the client responsible for them.
+	std::map<std::pair<wzapi::scripting_instance *, int>, unsigned> repeatTimerPeriodCounts;
 private:
 	scripting_engine() { }
 public:
@@ -410,6 +428,8 @@ private:
 	uniqueTimerID getNextAvailableTimerID();
 	// internal-only function that adds a Timer node (used for restoring saved games)
 	void addTimerNode(std::shared_ptr<timerNode>&& node);
+	// adds the timer to timerQueue, at its current frameTime
+	void scheduleTimer(const std::shared_ptr<timerNode>& node);
 
 // MARK: triggering events (from wz game code)
 public:
@@ -56,6 +56,8 @@
 
 #define HIT_NOTIFICATION	(GAME_TICKS_PER_SEC * 2)
 #define RADAR_FRAME_SKIP	10
+#define RADAR_ROW_MERGE_GAP	4	///< Changed rows at most this far apart are uploaded together.
+#define RADAR_KEY_INVALID	(~(uint64_t)0)
 
 bool bEnemyAllyRadarColor = false;     			/**< Enemy/ally radar color. */
 RADAR_DRAW_MODE	radarDrawMode = RADAR_MODE_DEFAULT;	/**< Current mini-map mode. */
@@ -117,8 +119,21 @@ static float RadarZoomMultiplier = 1.0f;
 static size_t radarBufferSize = 0;
 static int frameSkip = 0;
 
+// Change tracking, indexed like radarBuffer. Only texels whose inputs changed get recomputed, and only changed rows get uploaded.
+static std::vector<uint64_t> radarTileKeys;		///< Inputs of appliedRadarColour() the cached terrain colour was computed from.
+static std::vector<UDWORD> radarTerrainColours;		///< Terrain colour of each texel.
+static std::vector<UDWORD> radarDroidColours;		///< Droid colour of each texel, 0 if there's no droid.
+static std::vector<size_t> radarDroidTexels;		///< Texels with a non-zero radarDroidColours entry.
+static std::vector<bool> radarDirtyRows;		///< Rows changed by the last ComposeRadar().
+static unsigned radarTerrainState = ~0u;		///< Global inputs of appliedRadarColour() when the cache was filled.
+static bool radarTilesInvalid = true;
+static bool radarUploadAll = true;
+static size_t radarTexelsRewritten = 0;
+
 static void DrawRadarTiles();
 static void DrawRadarObjects();
+static void ComposeRadar();
+static void UploadRadar();
 static void DrawRadarExtras(const glm::mat4 &modelViewProjectionMatrix);
 static void DrawNorth(const glm::mat4 &modelViewProjectionMatrix);
 static void setViewingWindow();
@@ -172,6 +187,14 @@ bool resizeRadar()
 	radarBufferSize = radarTexWidth * radarTexHeight * sizeof(UDWORD);
 	radarBuffer = (uint32_t *)malloc(radarBufferSize);
 	memset(radarBuffer, 0, radarBufferSize);
+	size_t texels = radarTexWidth * radarTexHeight;
+	radarTileKeys.assign(texels, RADAR_KEY_INVALID);
+	radarTerrainColours.assign(texels, WZCOL_BLACK.rgba);	// border tiles are never recomputed and stay black
+	radarDroidColours.assign(texels, 0);
+	radarDroidTexels.clear();
+	radarDirtyRows.assign(radarTexHeight, false);
+	radarTilesInvalid = true;
+	radarUploadAll = true;
 	frameSkip = 0;
 	if (rotateRadar)
 	{
@@ -193,6 +216,11 @@ bool ShutdownRadar()
 {
 	free(radarBuffer);
 	radarBuffer = nullptr;
+	radarTileKeys.clear();
+	radarTerrainColours.clear();
+	radarDroidColours.clear();
+	radarDroidTexels.clear();
+	radarDirtyRows.clear();
 	frameSkip = 0;
 	return true;
 }
@@ -276,7 +304,8 @@ void drawRadar()
 	{
 		DrawRadarTiles();
 		DrawRadarObjects();
-		pie_DownLoadRadar(radarBuffer);
+		ComposeRadar();
+		UploadRadar();
 		frameSkip = RADAR_FRAME_SKIP;
 	}
 	frameSkip--;
@@ -391,145 +420,186 @@ static PIELIGHT appliedRadarColour(RADAR_DRAW_MODE drawMode, MAPTILE *WTile)
 	return WScr;
 }
 
-/** Draw the map tiles on the radar. */
+/** Pack everything appliedRadarColour() depends on for a single tile. Global inputs are covered by radarTerrainState. */
+static inline uint64_t radarTileKey(MAPTILE *psTile)
+{
+	uint64_t key = psTile->texture;
+	key |= (uint64_t)psTile->illumination << 16;
+	key |= (uint64_t)(uint32_t)psTile->height << 24;
+	key |= (uint64_t)(TEST_TILE_VISIBLE(selectedPlayer, psTile) != 0) << 56;
+	key |= (uint64_t)hasSensorOnTile(psTile, selectedPlayer) << 57;
+	return key;
+}
+
+/** Update the cached terrain colours of the tiles whose inputs changed since the last radar update. */
 static void DrawRadarTiles()
 {
-	SDWORD	x, y;
+	unsigned state = (unsigned)radarDrawMode | (getRevealStatus() ? 0x100 : 0);
+	if (state != radarTerrainState)
+	{
+		radarTerrainState = state;
+		radarTilesInvalid = true;
+	}
+	if (radarTilesInvalid)
+	{
+		std::fill(radarTileKeys.begin(), radarTileKeys.end(), RADAR_KEY_INVALID);
+		radarTilesInvalid = false;
+	}
 
-	for (x = scrollMinX; x < scrollMaxX; x++)
+	for (int y = scrollMinY + 1; y < scrollMaxY - 1; y++)
 	{
-		for (y = scrollMinY; y < scrollMaxY; y++)
+		size_t pos = radarTexWidth * (y - scrollMinY) + 1;
+		for (int x = scrollMinX + 1; x < scrollMaxX - 1; x++, pos++)
 		{
-			MAPTILE	*psTile = mapTile(x, y);
-			size_t pos = radarTexWidth * (y - scrollMinY) + (x - scrollMinX);
+			MAPTILE *psTile = mapTile(x, y);
+			uint64_t key = radarTileKey(psTile);
 
-			ASSERT(pos * sizeof(*radarBuffer) < radarBufferSize, "Buffer overrun");
-			if (y == scrollMinY || x == scrollMinX || y == scrollMaxY - 1 || x == scrollMaxX - 1)
+			if (key != radarTileKeys[pos])
 			{
-				radarBuffer[pos] = WZCOL_BLACK.rgba;
-				continue;
+				radarTileKeys[pos] = key;
+				radarTerrainColours[pos] = appliedRadarColour(radarDrawMode, psTile).rgba;
 			}
-			radarBuffer[pos] = appliedRadarColour(radarDrawMode, psTile).rgba;
 		}
 	}
 }
 
-/** Draw the droids and structure positions on the radar. */
-static void DrawRadarObjects()
+/** Radar colour of an object of the given player, flashing if it was recently hit. */
+static PIELIGHT radarObjectColour(int clan, UDWORD timeLastHit)
 {
-	UBYTE				clan;
-	PIELIGHT			playerCol;
-	PIELIGHT			flashCol;
-
-	/* Show droids on map - go through all players */
-	for (clan = 0; clan < MAX_PLAYERS; clan++)
+	if (clan == selectedPlayer && gameTime > HIT_NOTIFICATION && gameTime - timeLastHit < HIT_NOTIFICATION)
 	{
-		DROID		*psDroid;
-
-		//see if have to draw enemy/ally color
-		if (bEnemyAllyRadarColor)
-		{
-			if (clan == selectedPlayer)
-			{
-				playerCol = colRadarMe;
-			}
-			else
-			{
-				playerCol = (aiCheckAlliances(selectedPlayer, clan) ? colRadarAlly : colRadarEnemy);
-			}
-		}
-		else
+		STATIC_ASSERT(MAX_PLAYERS <= ARRAY_SIZE(flashColours));
+		return flashColours[getPlayerColour(clan)];
+	}
+	//see if have to draw enemy/ally color
+	if (bEnemyAllyRadarColor)
+	{
+		if (clan == selectedPlayer)
 		{
-			//original 8-color mode
-			STATIC_ASSERT(MAX_PLAYERS <= ARRAY_SIZE(clanColours));
-			playerCol = clanColours[getPlayerColour(clan)];
+			return colRadarMe;
 		}
+		return aiCheckAlliances(selectedPlayer, clan) ? colRadarAlly : colRadarEnemy;
+	}
+	//original 8-color mode
+	STATIC_ASSERT(MAX_PLAYERS <= ARRAY_SIZE(clanColours));
+	return clanColours[getPlayerColour(clan)];
+}
 
-		STATIC_ASSERT(MAX_PLAYERS <= ARRAY_SIZE(flashColours));
-		flashCol = flashColours[getPlayerColour(clan)];
+static inline bool radarObjectVisible(const BASE_OBJECT *psObj)
+{
+	return psObj->visible[selectedPlayer]
+	       || (bMultiPlayer && alliancesSharedVision(game.alliance)
+	           && aiCheckAlliances(selectedPlayer, psObj->player));
+}
 
-		/* Go through all droids */
-		for (psDroid = apsDroidLists[clan]; psDroid != nullptr; psDroid = psDroid->psNext)
+/** Draw the droid positions into the droid layer. */
+static void DrawRadarObjects()
+{
+	for (size_t pos : radarDroidTexels)
+	{
+		radarDroidColours[pos] = 0;
+	}
+	radarDroidTexels.clear();
+
+	/* Show droids on map - go through all players */
+	for (int clan = 0; clan < MAX_PLAYERS; clan++)
+	{
+		for (DROID *psDroid = apsDroidLists[clan]; psDroid != nullptr; psDroid = psDroid->psNext)
 		{
 			if (psDroid->pos.x < world_coord(scrollMinX) || psDroid->pos.y < world_coord(scrollMinY)
 			    || psDroid->pos.x >= world_coord(scrollMaxX) || psDroid->pos.y >= world_coord(scrollMaxY))
 			{
 				continue;
 			}
-			if (psDroid->visible[selectedPlayer]
-			    || (bMultiPlayer && alliancesSharedVision(game.alliance)
-			        && aiCheckAlliances(selectedPlayer, psDroid->player)))
+			if (radarObjectVisible(psDroid))
 			{
 				int	x = psDroid->pos.x / TILE_UNITS;
 				int	y = psDroid->pos.y / TILE_UNITS;
 				size_t	pos = (x - scrollMinX) + (y - scrollMinY) * radarTexWidth;
 
 				ASSERT(pos * sizeof(*radarBuffer) < radarBufferSize, "Buffer overrun");
-				if (clan == selectedPlayer && gameTime > HIT_NOTIFICATION && gameTime - psDroid->timeLastHit < HIT_NOTIFICATION)
+				if (radarDroidColours[pos] == 0)
 				{
-					radarBuffer[pos] = flashCol.rgba;
-				}
-				else
-				{
-					radarBuffer[pos] = playerCol.rgba;
+					radarDroidTexels.push_back(pos);
 				}
+				radarDroidColours[pos] = radarObjectColour(clan, psDroid->timeLastHit).rgba;
 			}
 		}
 	}
+}
 
-	/* Do the same for structures */
-	for (SDWORD x = scrollMinX; x < scrollMaxX; x++)
+/** Combine terrain, droids and structures into radarBuffer, and remember which rows changed. */
+static void ComposeRadar()
+{
+	radarTexelsRewritten = 0;
+	for (int y = scrollMinY; y < scrollMaxY; y++)
 	{
-		for (SDWORD y = scrollMinY; y < scrollMaxY; y++)
+		size_t row = y - scrollMinY;
+		size_t pos = radarTexWidth * row;
+		size_t rewritten = 0;
+		for (int x = scrollMinX; x < scrollMaxX; x++, pos++)
 		{
-			MAPTILE		*psTile = mapTile(x, y);
-			STRUCTURE	*psStruct;
-			size_t		pos = (x - scrollMinX) + (y - scrollMinY) * radarTexWidth;
+			MAPTILE *psTile = mapTile(x, y);
+			UDWORD colour = radarTerrainColours[pos];
 
-			ASSERT(pos * sizeof(*radarBuffer) < radarBufferSize, "Buffer overrun");
-			if (!TileHasStructure(psTile))
+			if (radarDroidColours[pos] != 0)
 			{
-				continue;
+				colour = radarDroidColours[pos];
 			}
-			psStruct = (STRUCTURE *)psTile->psObject;
-			clan = psStruct->player;
-
-			//see if have to draw enemy/ally color
-			if (bEnemyAllyRadarColor)
+			if (TileHasStructure(psTile))
 			{
-				if (clan == selectedPlayer)
-				{
-					playerCol = colRadarMe;
-				}
-				else
+				STRUCTURE *psStruct = (STRUCTURE *)psTile->psObject;
+				if (radarObjectVisible(psStruct))
 				{
-					playerCol = (aiCheckAlliances(selectedPlayer, clan) ? colRadarAlly : colRadarEnemy);
+					colour = radarObjectColour(psStruct->player, psStruct->timeLastHit).rgba;
 				}
 			}
-			else
+			if (radarBuffer[pos] != colour)
 			{
-				//original 8-color mode
-				playerCol = clanColours[getPlayerColour(clan)];
+				radarBuffer[pos] = colour;
+				rewritten++;
 			}
-			flashCol = flashColours[getPlayerColour(clan)];
+		}
+		radarDirtyRows[row] = rewritten != 0;
+		radarTexelsRewritten += rewritten;
+	}
+}
 
-			if (psStruct->visible[selectedPlayer]
-			    || (bMultiPlayer && alliancesSharedVision(game.alliance)
-			        && aiCheckAlliances(selectedPlayer, psStruct->player)))
+/** Upload the changed rows of radarBuffer, joining runs that are only a few rows apart. */
+static void UploadRadar()
+{
+	if (radarUploadAll)
+	{
+		pie_DownLoadRadar(radarBuffer);
+		radarUploadAll = false;
+		return;
+	}
+	size_t first = 0;
+	while (first < radarTexHeight)
+	{
+		if (!radarDirtyRows[first])
+		{
+			++first;
+			continue;
+		}
+		size_t last = first;
+		for (size_t row = first + 1; row < radarTexHeight && row <= last + RADAR_ROW_MERGE_GAP; ++row)
+		{
+			if (radarDirtyRows[row])
 			{
-				if (clan == selectedPlayer && gameTime > HIT_NOTIFICATION && gameTime - psStruct->timeLastHit < HIT_NOTIFICATION)
-				{
-					radarBuffer[pos] = flashCol.rgba;
-				}
-				else
-				{
-					radarBuffer[pos] = playerCol.rgba;
-				}
+				last = row;
 			}
 		}
+		pie_DownLoadRadarRows(radarBuffer, first, last - first + 1);
+		first = last + 1;
 	}
 }
 
+size_t radarTexelsRewrittenLastUpdate()
+{
+	return radarTexelsRewritten;
+}
+
 /** Rotate an array of 2d vectors about a given angle, also translates them after rotating. */
 static void RotateVector2D(Vector3i *Vector, Vector3i *TVector, Vector3i *Pos, int Angle, int Count)
 {
@@ -675,4 +745,5 @@ void radarColour(UDWORD tileNumber, uint8_t r, uint8_t g, uint8_t b)
 	tileColours[tileNumber].byte.g = g;
 	tileColours[tileNumber].byte.b = b;
 	tileColours[tileNumber].byte.a = 255;
+	radarTilesInvalid = true;
 }
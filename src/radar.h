@@ -43,6 +43,7 @@ void CalcRadarPosition(int mX, int mY, int *PosX, int *PosY);	///< Given a posit
 void SetRadarZoom(uint8_t ZoomLevel);		///< Set current zoom level. 1.0 is 1:1 resolution.
 uint8_t GetRadarZoom();			///< Get current zoom level.
 bool CoordInRadar(int x, int y);			///< Is screen coordinate inside minimap?
+size_t radarTexelsRewrittenLastUpdate();	///< Number of minimap texels that changed in the last minimap update.
 
 /** Different mini-map draw modes. */
 enum RADAR_DRAW_MODE
@@ -1279,6 +1279,7 @@ static void switchComponent(DROID *psDroid, UDWORD oldType, UDWORD oldCompInc,
 		abort();
 		return;
 	}
+	droidComponentsChanged(psDroid);
 }
 
 static inline bool allyResearchSortFunction(AllyResearch const &a, AllyResearch const &b)
@@ -30,9 +30,12 @@
  */
 
 #include <string.h>
+#include <atomic>
+#include <vector>
 
 #include "lib/framework/frame.h"
 #include "lib/framework/opengl.h"
+#include "lib/framework/wzapp.h"
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/imd.h"
 #include "lib/ivis_opengl/piefunc.h"
@@ -123,6 +126,23 @@ static int xSectors, ySectors;
 /// Did we initialise the terrain renderer yet?
 static bool terrainInitialised = false;
 
+/// Copies of the geometry, water and decal VBOs, so that each dirty sector is rebuilt into its own range
+static std::vector<RenderVertex> geometryStaging, waterStaging;
+static std::vector<DecalVertex> decalStaging;
+/// Sectors (as x * ySectors + y) being rebuilt this frame, in VBO order
+static std::vector<int> dirtySectors;
+/// Next entry of dirtySectors to rebuild, shared by the main thread and the terrain workers
+static std::atomic<size_t> nextDirtySector(0);
+
+/// Worker threads that help rebuild sectors when many change at once
+#define TERRAIN_WORKERS 3
+/// With fewer dirty sectors than this, the main thread rebuilds them alone
+#define TERRAIN_WORKER_MIN_SECTORS 4
+static WZ_THREAD *terrainWorkers[TERRAIN_WORKERS] = {};
+static WZ_SEMAPHORE *terrainWorkSemaphore = nullptr;
+static WZ_SEMAPHORE *terrainWorkDoneSemaphore = nullptr;
+static bool terrainWorkersQuit = false;
+
 /// Helper to specify the offset in a VBO
 #define BUFFER_OFFSET(i) (reinterpret_cast<char *>(i))
 
@@ -481,54 +501,162 @@ static void setSectorDecals(int x, int y, DecalVertex *decaldata, int *decalSize
 }
 
 /**
- * Update the sector for when the terrain is changed.
+ * Rebuild the geometry, water and decals of a sector into the staging buffers.
+ * Only reads the map, so it may run on the terrain workers.
  */
-static void updateSectorGeometry(int x, int y)
+static void buildSectorGeometry(int sector)
 {
-	RenderVertex *geometry;
-	RenderVertex *water;
-	DecalVertex *decaldata;
-	int geometrySize = 0;
-	int waterSize = 0;
+	const int x = sector / ySectors;
+	const int y = sector % ySectors;
+	const Sector &psSector = sectors[sector];
+	int geometrySize = psSector.geometryOffset;
+	int waterSize = psSector.waterOffset;
+
+	setSectorGeometry(x, y, geometryStaging.data(), waterStaging.data(), &geometrySize, &waterSize);
+	ASSERT(geometrySize - psSector.geometryOffset == psSector.geometrySize, "something went seriously wrong updating the terrain");
+	ASSERT(waterSize - psSector.waterOffset == psSector.waterSize, "something went seriously wrong updating the terrain");
+
+	if (psSector.decalSize <= 0)
+	{
+		return;
+	}
+
+	// The decals of a sector must still fit in its range, or they would overwrite the next sector.
 	int decalSize = 0;
+	for (int i = std::max(x * sectorSize, 0); i < std::min(x * sectorSize + sectorSize, mapWidth); i++)
+	{
+		for (int j = std::max(y * sectorSize, 0); j < std::min(y * sectorSize + sectorSize, mapHeight); j++)
+		{
+			decalSize += TILE_HAS_DECAL(mapTile(i, j)) ? 12 : 0;
+		}
+	}
+	ASSERT_OR_RETURN(, decalSize == psSector.decalSize, "the amount of decals has changed");
 
-	geometry  = (RenderVertex *)malloc(sizeof(RenderVertex) * sectors[x * ySectors + y].geometrySize);
-	water     = (RenderVertex *)malloc(sizeof(RenderVertex) * sectors[x * ySectors + y].waterSize);
+	decalSize = psSector.decalOffset;
+	setSectorDecals(x, y, decalStaging.data(), &decalSize);
+}
 
-	setSectorGeometry(x, y, geometry, water, &geometrySize, &waterSize);
-	ASSERT(geometrySize == sectors[x * ySectors + y].geometrySize, "something went seriously wrong updating the terrain");
-	ASSERT(waterSize    == sectors[x * ySectors + y].waterSize   , "something went seriously wrong updating the terrain");
+/// Rebuild dirty sectors until there are none left. Runs on the main thread and on the terrain workers.
+static void buildDirtySectors()
+{
+	for (size_t i = nextDirtySector++; i < dirtySectors.size(); i = nextDirtySector++)
+	{
+		buildSectorGeometry(dirtySectors[i]);
+	}
+}
 
-	geometryVBO->update(sizeof(RenderVertex)*sectors[x * ySectors + y].geometryOffset,
-	                    sizeof(RenderVertex)*sectors[x * ySectors + y].geometrySize, geometry,
-						gfx_api::buffer::update_flag::non_overlapping_updates_promise);
-	waterVBO->update(sizeof(RenderVertex)*sectors[x * ySectors + y].waterOffset,
-	                 sizeof(RenderVertex)*sectors[x * ySectors + y].waterSize, water,
-					 gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+// This function runs in a separate thread!
+static int terrainWorkerFunc(WZ_DECL_UNUSED void *data)
+{
+	while (true)
+	{
+		wzSemaphoreWait(terrainWorkSemaphore);  // Go to sleep until needed.
+		if (terrainWorkersQuit)
+		{
+			break;
+		}
+		buildDirtySectors();
+		wzSemaphorePost(terrainWorkDoneSemaphore);  // Signal that we are done.
+	}
+	return 0;
+}
 
-	free(geometry);
-	free(water);
+static void startTerrainWorkers()
+{
+	terrainWorkersQuit = false;
+	terrainWorkSemaphore = wzSemaphoreCreate(0);
+	terrainWorkDoneSemaphore = wzSemaphoreCreate(0);
+	for (WZ_THREAD *&worker : terrainWorkers)
+	{
+		worker = wzThreadCreate(terrainWorkerFunc, nullptr);
+		wzThreadStart(worker);
+	}
+}
 
-	if (sectors[x * ySectors + y].decalSize <= 0)
+static void stopTerrainWorkers()
+{
+	if (terrainWorkSemaphore == nullptr)
 	{
-		// Nothing to do here, and glBufferSubData(GL_ARRAY_BUFFER, 0, 0, *) crashes in my graphics driver. Probably shouldn't crash...
 		return;
 	}
+	terrainWorkersQuit = true;
+	for (size_t i = 0; i < TERRAIN_WORKERS; ++i)
+	{
+		wzSemaphorePost(terrainWorkSemaphore);
+	}
+	for (WZ_THREAD *&worker : terrainWorkers)
+	{
+		wzThreadJoin(worker);
+		worker = nullptr;
+	}
+	wzSemaphoreDestroy(terrainWorkSemaphore);
+	terrainWorkSemaphore = nullptr;
+	wzSemaphoreDestroy(terrainWorkDoneSemaphore);
+	terrainWorkDoneSemaphore = nullptr;
+}
 
-	decaldata = (DecalVertex *)malloc(sizeof(DecalVertex) * sectors[x * ySectors + y].decalSize);
-	setSectorDecals(x, y, decaldata, &decalSize);
-	ASSERT(decalSize == sectors[x * ySectors + y].decalSize   , "the amount of decals has changed");
+/// Upload the rebuilt ranges of a staging buffer, merging the ranges of consecutive sectors into one update.
+template <typename T>
+static void uploadDirtyRanges(gfx_api::buffer *buffer, const std::vector<T> &staging, int Sector::*offset, int Sector::*size)
+{
+	size_t i = 0;
+	while (i < dirtySectors.size())
+	{
+		const int start = sectors[dirtySectors[i]].*offset;
+		int end = start + sectors[dirtySectors[i]].*size;
+		for (++i; i < dirtySectors.size() && sectors[dirtySectors[i]].*offset == end; ++i)
+		{
+			end += sectors[dirtySectors[i]].*size;
+		}
+		// Empty updates are skipped, since glBufferSubData(GL_ARRAY_BUFFER, 0, 0, *) crashes some drivers.
+		if (end > start)
+		{
+			buffer->update(sizeof(T) * start, sizeof(T) * (end - start), &staging[start], gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+		}
+	}
+}
 
-	decalVBO->update(sizeof(DecalVertex)*sectors[x * ySectors + y].decalOffset,
-	                 sizeof(DecalVertex)*sectors[x * ySectors + y].decalSize, decaldata,
-					 gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+/**
+ * Update the sectors in dirtySectors for when the terrain is changed.
+ */
+static void updateDirtySectors()
+{
+	if (dirtySectors.empty())
+	{
+		return;
+	}
 
-	free(decaldata);
+	nextDirtySector = 0;
+	const bool useWorkers = dirtySectors.size() >= TERRAIN_WORKER_MIN_SECTORS;
+	if (useWorkers)
+	{
+		if (terrainWorkSemaphore == nullptr)
+		{
+			startTerrainWorkers();
+		}
+		for (size_t i = 0; i < TERRAIN_WORKERS; ++i)
+		{
+			wzSemaphorePost(terrainWorkSemaphore);
+		}
+	}
+	buildDirtySectors();
+	if (useWorkers)
+	{
+		for (size_t i = 0; i < TERRAIN_WORKERS; ++i)
+		{
+			wzSemaphoreWait(terrainWorkDoneSemaphore);
+		}
+	}
+
+	uploadDirtyRanges(geometryVBO, geometryStaging, &Sector::geometryOffset, &Sector::geometrySize);
+	uploadDirtyRanges(waterVBO, waterStaging, &Sector::waterOffset, &Sector::waterSize);
+	uploadDirtyRanges(decalVBO, decalStaging, &Sector::decalOffset, &Sector::decalSize);
+	dirtySectors.clear();
 }
 
 /**
  * Mark all tiles that are influenced by this grid point as dirty.
- * Dirty sectors will later get updated by updateSectorGeometry.
+ * Dirty sectors will later get updated by updateDirtySectors.
  */
 void markTileDirty(int i, int j)
 {
@@ -762,6 +890,7 @@ bool initTerrain()
 		delete geometryVBO;
 	geometryVBO = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::dynamic_draw);
 	geometryVBO->upload(sizeof(RenderVertex)*geometrySize, geometry);
+	geometryStaging.assign(geometry, geometry + geometrySize);
 	free(geometry);
 
 	if (geometryIndexVBO)
@@ -774,6 +903,7 @@ bool initTerrain()
 		delete waterVBO;
 	waterVBO = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::dynamic_draw);
 	waterVBO->upload(sizeof(RenderVertex)*waterSize, water);
+	waterStaging.assign(water, water + waterSize);
 	free(water);
 
 	if (waterIndexVBO)
@@ -922,6 +1052,7 @@ bool initTerrain()
 		delete decalVBO;
 	decalVBO = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::dynamic_draw);
 	decalVBO->upload(sizeof(DecalVertex)*decalSize, decaldata);
+	decalStaging.assign(decaldata, decaldata + decalSize);
 	free(decaldata);
 
 	lightmap_tex_num = 0;
@@ -962,6 +1093,11 @@ void shutdownTerrain()
 		debug(LOG_ERROR, "Trying to shutdown terrain when we did not need to!");
 		return;
 	}
+	stopTerrainWorkers();
+	geometryStaging = std::vector<RenderVertex>();
+	waterStaging = std::vector<RenderVertex>();
+	decalStaging = std::vector<DecalVertex>();
+	dirtySectors.clear();
 	delete geometryVBO;
 	geometryVBO = nullptr;
 	delete geometryIndexVBO;
@@ -1085,12 +1221,13 @@ static void cullTerrain()
 				sectors[x * ySectors + y].draw = true;
 				if (sectors[x * ySectors + y].dirty)
 				{
-					updateSectorGeometry(x, y);
+					dirtySectors.push_back(x * ySectors + y);
 					sectors[x * ySectors + y].dirty = false;
 				}
 			}
 		}
 	}
+	updateDirtySectors();
 }
 
 static void drawDepthOnly(const glm::mat4 &ModelViewProjection, const glm::vec4 &paramsXLight, const glm::vec4 &paramsYLight)
@@ -3235,6 +3235,7 @@ wzapi::no_return_value wzapi::fireWeaponAtObj(WZAPI_PARAMS(std::string weaponNam
 // flag all droids as requiring update on next frame
 static void dirtyAllDroids(int player)
 {
+	droidUpgradesChanged(player);
 	for (DROID *psDroid = apsDroidLists[player]; psDroid != nullptr; psDroid = psDroid->psNext)
 	{
 		psDroid->flags.set(OBJECT_FLAG_DIRTY);
@@ -259,6 +259,14 @@ static nlohmann::ordered_json fillMainModel()
 	result["difficultyLevel"] = difficulty_type.at(getDifficultyLevel());
 	result["loopPieCount"] = loopPieCount;
 	result["loopPolyCount"] = loopPolyCount;
+	result["loopDrawCount"] = loopDrawCount;
+	result["loopStateChangeCount"] = loopStateChangeCount;
+	result["loopObjectsVisitedCount"] = loopObjectsVisitedCount;
+	result["loopWidgetsDisplayedCount"] = loopWidgetsDisplayedCount;
+	result["loopWidgetsChangedCount"] = loopWidgetsChangedCount;
+	result["loopBatch2DDrawCount"] = loopBatch2DDrawCount;
+	result["loopBatch2DCount"] = loopBatch2DCount;
+	result["loopTextDrawCount"] = loopTextDrawCount;
 	result["allowDesign"] = allowDesign;
 	result["includeRedundantDesigns"] = includeRedundantDesigns;
 
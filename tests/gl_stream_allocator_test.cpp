@@ -0,0 +1,230 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/ivis_opengl/gl_stream_allocator.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Checks the ring suballocator used to stream vertex data in the OpenGL backend, without a GPU.
+// The invariant: between two orphans, no two allocations or claims overlap, so a range written
+// without synchronisation is never one the GPU may still be reading.
+
+// --- dummy thread implementation for the log writer thread ---
+
+struct WZ_THREAD
+{
+	std::thread thread;
+	int (*threadFunc)(void *);
+	void *data;
+	int result;
+};
+
+struct WZ_MUTEX
+{
+	std::mutex mutex;
+};
+
+struct WZ_SEMAPHORE
+{
+	std::mutex mutex;
+	std::condition_variable cond;
+	int value;
+};
+
+WZ_THREAD *wzThreadCreate(int (*threadFunc)(void *), void *data)
+{
+	WZ_THREAD *thread = new WZ_THREAD;
+	thread->threadFunc = threadFunc;
+	thread->data = data;
+	thread->result = 0;
+	return thread;
+}
+
+void wzThreadStart(WZ_THREAD *thread)
+{
+	thread->thread = std::thread([thread] { thread->result = thread->threadFunc(thread->data); });
+}
+
+int wzThreadJoin(WZ_THREAD *thread)
+{
+	thread->thread.join();
+	int result = thread->result;
+	delete thread;
+	return result;
+}
+
+WZ_MUTEX *wzMutexCreate()
+{
+	return new WZ_MUTEX;
+}
+
+void wzMutexDestroy(WZ_MUTEX *mutex)
+{
+	delete mutex;
+}
+
+void wzMutexLock(WZ_MUTEX *mutex)
+{
+	mutex->mutex.lock();
+}
+
+void wzMutexUnlock(WZ_MUTEX *mutex)
+{
+	mutex->mutex.unlock();
+}
+
+bool wzMutexTryLock(WZ_MUTEX *mutex)
+{
+	return mutex->mutex.try_lock();
+}
+
+WZ_SEMAPHORE *wzSemaphoreCreate(int startValue)
+{
+	WZ_SEMAPHORE *semaphore = new WZ_SEMAPHORE;
+	semaphore->value = startValue;
+	return semaphore;
+}
+
+void wzSemaphoreDestroy(WZ_SEMAPHORE *semaphore)
+{
+	delete semaphore;
+}
+
+void wzSemaphoreWait(WZ_SEMAPHORE *semaphore)
+{
+	std::unique_lock<std::mutex> lock(semaphore->mutex);
+	semaphore->cond.wait(lock, [semaphore] { return semaphore->value > 0; });
+	--semaphore->value;
+}
+
+void wzSemaphorePost(WZ_SEMAPHORE *semaphore)
+{
+	std::lock_guard<std::mutex> lock(semaphore->mutex);
+	++semaphore->value;
+	semaphore->cond.notify_one();
+}
+
+int wzGetTicks()
+{
+	static const auto start = std::chrono::steady_clock::now();
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --- dummy window implementation for the debug log ---
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+bool wzChangeWindowMode(WINDOW_MODE)
+{
+	return false;
+}
+
+void wzDisplayDialog(DialogType, const char *, const char *)
+{
+}
+
+// --- end linking hacks ---
+
+static int failures = 0;
+
+#define CHECK(expr) do { if (!(expr)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); ++failures; } } while (0)
+
+static void testAllocate()
+{
+	gl_stream_allocator ring(1024);
+
+	// The first allocation has no storage to write to yet.
+	gl_stream_allocator::allocation a = ring.allocate(100, 16);
+	CHECK(a.orphan && a.offset == 0);
+
+	// Later allocations are aligned, and follow on without orphaning.
+	a = ring.allocate(10, 16);
+	CHECK(!a.orphan && a.offset == 112);
+	a = ring.allocate(10, 4);
+	CHECK(!a.orphan && a.offset == 124);
+
+	// One that does not fit in the rest of the ring starts over.
+	a = ring.allocate(900, 16);
+	CHECK(a.orphan && a.offset == 0);
+	CHECK(ring.capacity() == 1024);
+
+	// An exact fit does not orphan.
+	a = ring.allocate(124, 1);
+	CHECK(!a.orphan && a.offset == 900);
+	a = ring.allocate(1, 1);
+	CHECK(a.orphan && a.offset == 0);
+
+	// One larger than the ring grows it.
+	a = ring.allocate(3000, 16);
+	CHECK(a.orphan && a.offset == 0);
+	CHECK(ring.capacity() == 4096);
+
+	// Forgetting the storage orphans on the next allocation.
+	ring.reset();
+	a = ring.allocate(16, 16);
+	CHECK(a.orphan && a.offset == 0);
+}
+
+static void testNoOverlapBetweenOrphans()
+{
+	gl_stream_allocator ring(4096);
+	size_t written = 0;	// Bytes in use since the last orphan
+	unsigned seed = 1;
+	for (unsigned i = 0; i < 100000; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		const size_t size = 1 + (seed >> 16) % 1500;
+		const size_t alignment = (size_t)1 << ((seed >> 8) % 6);
+		const gl_stream_allocator::allocation a = ring.allocate(size, alignment);
+		if (a.orphan)
+		{
+			written = 0;
+		}
+		CHECK(a.offset % alignment == 0);
+		CHECK(a.offset >= written);
+		CHECK(a.offset + size <= ring.capacity());
+		written = a.offset + size;
+	}
+}
+
+static void testClaim()
+{
+	gl_stream_allocator ranges(0);
+	ranges.respecified(1024);
+
+	// Fresh storage is written front to back without orphaning.
+	CHECK(!ranges.claim(0, 100).orphan);
+	CHECK(!ranges.claim(100, 200).orphan);
+	CHECK(!ranges.claim(400, 624).orphan);
+
+	// Starting over at a lower offset, as a stream buffer does in the next frame, orphans once.
+	CHECK(ranges.claim(0, 50).orphan);
+	CHECK(!ranges.claim(64, 50).orphan);
+
+	// Overlapping the last range also orphans.
+	CHECK(ranges.claim(100, 10).orphan);
+
+	// Without storage, the first claim orphans.
+	ranges.reset();
+	CHECK(ranges.claim(512, 10).orphan);
+}
+
+int main(void)
+{
+	testAllocate();
+	testNoOverlapBetweenOrphans();
+	testClaim();
+	if (failures > 0)
+	{
+		fprintf(stderr, "%d checks failed\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,304 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/netplay/netsocket.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Opens many compressed connections to ourselves, writes to them from this thread while the socket
+// thread compresses and sends, and closes each sending socket while its data is still queued.
+// Every byte must still arrive, in order, before the receiving end sees the disconnect.
+
+#define STRESS_PORT_FIRST	23100
+#define STRESS_PORT_COUNT	20
+#define STRESS_ROUNDS		8
+#define STRESS_CONNECTIONS	24
+#define STRESS_WRITES		200
+#define STRESS_TIMEOUT		20000	///< Milliseconds to wait for the data of one round
+
+// --- dummy thread implementation for the socket thread ---
+
+struct WZ_THREAD
+{
+	std::thread thread;
+	int (*threadFunc)(void *);
+	void *data;
+	int result;
+};
+
+struct WZ_MUTEX
+{
+	std::mutex mutex;
+};
+
+struct WZ_SEMAPHORE
+{
+	std::mutex mutex;
+	std::condition_variable cond;
+	int value;
+};
+
+WZ_THREAD *wzThreadCreate(int (*threadFunc)(void *), void *data)
+{
+	WZ_THREAD *thread = new WZ_THREAD;
+	thread->threadFunc = threadFunc;
+	thread->data = data;
+	thread->result = 0;
+	return thread;
+}
+
+void wzThreadStart(WZ_THREAD *thread)
+{
+	thread->thread = std::thread([thread] { thread->result = thread->threadFunc(thread->data); });
+}
+
+int wzThreadJoin(WZ_THREAD *thread)
+{
+	thread->thread.join();
+	int result = thread->result;
+	delete thread;
+	return result;
+}
+
+WZ_MUTEX *wzMutexCreate()
+{
+	return new WZ_MUTEX;
+}
+
+void wzMutexDestroy(WZ_MUTEX *mutex)
+{
+	delete mutex;
+}
+
+void wzMutexLock(WZ_MUTEX *mutex)
+{
+	mutex->mutex.lock();
+}
+
+void wzMutexUnlock(WZ_MUTEX *mutex)
+{
+	mutex->mutex.unlock();
+}
+
+bool wzMutexTryLock(WZ_MUTEX *mutex)
+{
+	return mutex->mutex.try_lock();
+}
+
+WZ_SEMAPHORE *wzSemaphoreCreate(int startValue)
+{
+	WZ_SEMAPHORE *semaphore = new WZ_SEMAPHORE;
+	semaphore->value = startValue;
+	return semaphore;
+}
+
+void wzSemaphoreDestroy(WZ_SEMAPHORE *semaphore)
+{
+	delete semaphore;
+}
+
+void wzSemaphoreWait(WZ_SEMAPHORE *semaphore)
+{
+	std::unique_lock<std::mutex> lock(semaphore->mutex);
+	semaphore->cond.wait(lock, [semaphore] { return semaphore->value > 0; });
+	--semaphore->value;
+}
+
+void wzSemaphorePost(WZ_SEMAPHORE *semaphore)
+{
+	std::lock_guard<std::mutex> lock(semaphore->mutex);
+	++semaphore->value;
+	semaphore->cond.notify_one();
+}
+
+int wzGetTicks()
+{
+	static const auto start = std::chrono::steady_clock::now();
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --- dummy window implementation for the debug log ---
+
+bool wzIsFullscreen()
+{
+	return false;
+}
+
+bool wzChangeWindowMode(WINDOW_MODE)
+{
+	return false;
+}
+
+void wzDisplayDialog(DialogType, const char *, const char *)
+{
+}
+
+// --- end linking hacks ---
+
+/// The byte at offset pos of the stream sent over connection conn.
+static uint8_t streamByte(unsigned conn, size_t pos)
+{
+	return (uint8_t)((pos * 7 + conn * 13 + (pos >> 9)) & 0xFF);
+}
+
+struct Receiver
+{
+	Socket *sock = nullptr;
+	size_t expected = 0;
+	size_t received = 0;
+	bool disconnected = false;
+	bool corrupt = false;
+};
+
+static bool runRound(Socket *listenSocket, SocketAddress *addr, unsigned round)
+{
+	std::vector<Socket *> senders;
+	std::vector<Receiver> receivers(STRESS_CONNECTIONS);
+	SocketSet *set = allocSocketSet();
+
+	// Connect, accepting in the same order as we connect, so that receivers[i] reads what senders[i] writes.
+	for (unsigned i = 0; i < STRESS_CONNECTIONS; ++i)
+	{
+		Socket *sender = socketOpen(addr, 2000);
+		if (sender == nullptr)
+		{
+			fprintf(stderr, "round %u: connection %u failed\n", round, i);
+			return false;
+		}
+		senders.push_back(sender);
+		const int deadline = wzGetTicks() + 2000;
+		while (receivers[i].sock == nullptr && wzGetTicks() < deadline)
+		{
+			receivers[i].sock = socketAccept(listenSocket);
+			if (receivers[i].sock == nullptr)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+		if (receivers[i].sock == nullptr)
+		{
+			fprintf(stderr, "round %u: connection %u was never accepted\n", round, i);
+			return false;
+		}
+		socketBeginCompression(sender);
+		socketBeginCompression(receivers[i].sock);
+		SocketSet_AddSocket(set, receivers[i].sock);
+	}
+
+	// Write, flushing now and then, and close each sender right after its last flush.
+	std::vector<uint8_t> buf;
+	for (unsigned w = 0; w < STRESS_WRITES; ++w)
+	{
+		for (unsigned i = 0; i < STRESS_CONNECTIONS; ++i)
+		{
+			const size_t size = 1 + (w * 131 + i * 17 + round * 7) % 4096;
+			buf.resize(size);
+			for (size_t n = 0; n < size; ++n)
+			{
+				buf[n] = streamByte(i, receivers[i].expected + n);
+			}
+			writeAll(senders[i], buf.data(), size);
+			receivers[i].expected += size;
+			if (w % (1 + i % 5) == 0 || w == STRESS_WRITES - 1)
+			{
+				socketFlush(senders[i]);
+			}
+		}
+	}
+	for (unsigned i = 0; i < STRESS_CONNECTIONS; ++i)
+	{
+		socketClose(senders[i]);
+	}
+
+	// Read everything, until each receiver sees its sender disconnect.
+	unsigned remaining = STRESS_CONNECTIONS;
+	const int deadline = wzGetTicks() + STRESS_TIMEOUT;
+	uint8_t readBuf[8192];
+	while (remaining > 0 && wzGetTicks() < deadline)
+	{
+		if (checkSockets(set, 100) <= 0)
+		{
+			continue;
+		}
+		for (Receiver &receiver : receivers)
+		{
+			if (receiver.disconnected || !socketReadReady(receiver.sock))
+			{
+				continue;
+			}
+			const unsigned conn = &receiver - &receivers[0];
+			ssize_t size = readNoInt(receiver.sock, readBuf, sizeof(readBuf));
+			if (size > 0)
+			{
+				for (ssize_t n = 0; n < size; ++n)
+				{
+					receiver.corrupt |= readBuf[n] != streamByte(conn, receiver.received + n);
+				}
+				receiver.received += size;
+			}
+			else if (size == SOCKET_ERROR || socketReadDisconnected(receiver.sock))
+			{
+				receiver.disconnected = true;
+				--remaining;
+			}
+		}
+	}
+
+	bool ok = true;
+	for (Receiver &receiver : receivers)
+	{
+		const unsigned conn = &receiver - &receivers[0];
+		if (!receiver.disconnected || receiver.corrupt || receiver.received != receiver.expected)
+		{
+			fprintf(stderr, "round %u: connection %u got %zu of %zu bytes%s%s\n", round, conn, receiver.received, receiver.expected,
+			        receiver.corrupt ? ", corrupted" : "", receiver.disconnected ? "" : ", never disconnected");
+			ok = false;
+		}
+		SocketSet_DelSocket(set, receiver.sock);
+		socketClose(receiver.sock);
+	}
+	deleteSocketSet(set);
+	return ok;
+}
+
+int main(void)
+{
+	SOCKETinit();
+
+	Socket *listenSocket = nullptr;
+	unsigned port = STRESS_PORT_FIRST;
+	for (; port < STRESS_PORT_FIRST + STRESS_PORT_COUNT && listenSocket == nullptr; ++port)
+	{
+		listenSocket = socketListen(port);
+	}
+	if (listenSocket == nullptr)
+	{
+		fprintf(stderr, "Failed to listen on any port\n");
+		SOCKETshutdown();
+		return 1;
+	}
+	SocketAddress *addr = resolveHost("127.0.0.1", port - 1);
+	if (addr == nullptr)
+	{
+		fprintf(stderr, "Failed to resolve localhost\n");
+		socketClose(listenSocket);
+		SOCKETshutdown();
+		return 1;
+	}
+
+	bool ok = true;
+	for (unsigned round = 0; round < STRESS_ROUNDS && ok; ++round)
+	{
+		ok = runRound(listenSocket, addr, round);
+	}
+
+	deleteSocketAddress(addr);
+	socketClose(listenSocket);
+	SOCKETshutdown();
+	return ok ? 0 : 1;
+}